@@ -25,6 +25,9 @@
 #include "inet/common/packet/Packet.h"
 #include "inet/networklayer/common/FragmentationTag_m.h"
 #include "inet/networklayer/common/L3AddressResolver.h"
+#include "inet/routing/rpl/HostBindings.h"
+#include "inet/routing/rpl/FeatureExport.h"
+#include "inet/routing/rpl/PacketTrace.h"
 #include "inet/transportlayer/contract/udp/UdpControlInfo_m.h"
 //#include "C:/omnetpp-5.6.2/MyWorkspaces/ComNestHH_CLv3/rpl/src/Rpl.h"
 
@@ -61,6 +64,12 @@ void UdpBasicApp::initialize(int stage)
             throw cRuntimeError("Invalid startTime/stopTime parameters");
         selfMsg = new cMessage("sendTimer");
     }
+    else if (stage == INITSTAGE_APPLICATION_LAYER) {
+        // MAC and RPL of this host, to read their state on every packet sent
+        auto bindings = HostBindings::get(this);
+        mac = bindings->getMac();
+        rpl = bindings->getRpl();
+    }
 }
 
 void UdpBasicApp::finish()
@@ -134,20 +143,11 @@ void UdpBasicApp::sendPacket()
 
     //CL: 2021-06-16
     //To register when the packet was sent.
-    std:: ofstream file;
-    file.open("St_packet-tracer.txt", std::ios_base::app);
     std::string packetName = packet->getName();
 
     int packetSize = par("messageLength");
     //EV_INFO << "packet size: " << packetSize << endl;
 
-    //To get variables from other places
-    macModule = getParentModule()->getSubmodule("wlan",0)->getSubmodule("mac");
-    mac = check_and_cast<Ieee802154Mac *>(macModule);
-
-    rplModule = getParentModule()->getSubmodule("rpl");
-    //EV_INFO << rplModule << endl;
-    rpl = check_and_cast<Rpl *>(rplModule);
     //EV_INFO << rpl->getRank() << endl;
 
     //To get the best candidate to send the packet before sending
@@ -169,68 +169,6 @@ void UdpBasicApp::sendPacket()
          " " << rpl->getRank() <<endl;
 */
     //file << simTime() <<" " <<getParentModule()->getFullName() << " pkt_sent " << packetName << endl;
-    double fail_retry = 0;
-    double fail_cong = 0;
-    double fail_retry_current_value;
-    double fail_cong_current_value;
-    double rx_frame_rate;
-    double current_rx_frame_rate = mac->nbRxFrames_copy;
-
-    if (simTime() - mac->last_reading > 300){
-        double beta = 0.9;
-            //dio->setRx_suc_rate(beta*(radio->rx_successful_rate) + (1-beta)*radio->rx_successful_rate_copy);
-        if (mac->nbTxFrames_copy + mac->txAttempts_copy == 0)
-            fail_retry_current_value = 0;
-        else
-            fail_retry_current_value = (mac->framedropbyretry_limit_reached + mac->txAttempts_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy);
-
-        fail_retry = beta*fail_retry_current_value + (1-beta)*mac->fail_rate_retry ;
-
-        if (mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy == 0)
-            fail_cong_current_value = 0;
-        else
-            fail_cong_current_value = (mac->framedropbycongestion + mac->txAttempts_copy + mac->NB_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy);
-
-        fail_cong = beta*fail_cong_current_value + (1-beta)*mac->fail_rate_cong ;
-
-        rx_frame_rate = beta*current_rx_frame_rate + (1-beta)*mac->rx_frames_rate ;  //check this!!!!!!!!
-
-    } else {
-        double beta = 0.6;
-        if (mac->nbTxFrames_copy + mac->txAttempts_copy == 0)
-            fail_retry_current_value = 0;
-        else
-            fail_retry_current_value = (mac->framedropbyretry_limit_reached + mac->txAttempts_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy);
-
-        fail_retry = beta*fail_retry_current_value + (1-beta)*mac->fail_rate_retry ;
-
-        if (mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy == 0)
-            fail_cong_current_value = 0;
-        else
-            fail_cong_current_value = (mac->framedropbycongestion + mac->txAttempts_copy + mac->NB_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy);
-
-        fail_cong = beta*fail_cong_current_value + (1-beta)*mac->fail_rate_cong ;
-
-        rx_frame_rate = beta*current_rx_frame_rate + (1-beta)*mac->rx_frames_rate ;  //check this!!!!!!!!
-    }
-
-    //To do the same with the ch utilization
-    double current_ch_util;
-    if ((mac->busy + mac->idle) == 0)
-        current_ch_util = 0;
-    else
-        current_ch_util =mac->busy/(mac->busy + mac->idle);
-
-    double my_ch_util = 0;
-
-    if (simTime() - mac->last_ch_uti_reset > 300){
-        double beta = 0.9;
-        my_ch_util = beta*current_ch_util + (1-beta)*mac->channel_util ;
-    } else {
-        double beta = 0.6;
-        my_ch_util = beta*current_ch_util + (1-beta)*mac->channel_util ;
-    }
-
 
 /*
     file << simTime() <<" " << getParentModule()->getFullName() << " pkt_sent " << packetName <<" " <<
@@ -244,17 +182,44 @@ void UdpBasicApp::sendPacket()
          round(rpl->getsnr_inst()*100)/100.0 << " " << round(rpl->getRXsucrate()*100.0)/100.0 << " " << endl ;
 */
 
-    file << simTime() <<" " << getParentModule()->getFullName() << " pkt_sent " << packetName <<" " <<
-                rpl->getHC() << " " << round(rpl->getETX()*100.0)/100.0 << " " <<  rpl->getdropB() << " " <<
-                rpl->getdropR() << " " << round(rpl->gettxF()*100.0)/100.0 << " " << round(rpl->getrxF()*100.0)/100.0 << " " <<
-                round(rpl->getbw()*100.0)/100.0 << " " << rpl->getden() << " " << round(rpl->getqu()*100.0)/100.0 << " " <<
-                round(my_ch_util*100.0)/100.0 << " " << round(mac->qu*100.0)/100.0 << " " <<
-                round(fail_retry*100.0)/100.0 << " " << round(fail_cong*100.0)/100.0 << " " <<
-                rpl->getneighbors() << " " << round(rpl->getetx_int()*100.0)/100.0 << " " <<
-                round(rpl->getfps()*100.0)/100.0 << " " << rpl->getlastupdate()  << " " << rpl->getSNR() <<
-                " " << round(rpl->getsnr_inst()*100)/100.0 << " " << round(rx_frame_rate*100.0)/100.0 << endl ;
-
-    file.close();
+    //fail rates, rx frame rate and channel utilization as estimated by the MAC
+    const LinkMetrics& linkMetrics = mac->getLinkMetrics();
+    PacketTraceRecord record;
+    record.time = simTime();
+    record.node = getParentModule()->getFullName();
+    record.event = "pkt_sent";
+    record.packet = packetName.c_str();
+    record.hc = rpl->getHC();
+    record.etx = round(rpl->getETX()*100.0)/100.0;
+    record.dropB = rpl->getdropB();
+    record.dropR = rpl->getdropR();
+    record.txF = round(rpl->gettxF()*100.0)/100.0;
+    record.rxF = round(rpl->getrxF()*100.0)/100.0;
+    record.bw = round(rpl->getbw()*100.0)/100.0;
+    record.den = rpl->getden();
+    record.qu = round(rpl->getqu()*100.0)/100.0;
+    record.chUtil = round(linkMetrics.getChannelUtilization()*100.0)/100.0;
+    record.macQu = round(linkMetrics.getQueueUtilization()*100.0)/100.0;
+    record.failRetry = round(linkMetrics.getFailRateRetry()*100.0)/100.0;
+    record.failCong = round(linkMetrics.getFailRateCong()*100.0)/100.0;
+    record.neighbors = rpl->getneighbors();
+    record.etxInst = round(rpl->getetx_int()*100.0)/100.0;
+    record.fps = round(rpl->getfps()*100.0)/100.0;
+    record.lastUpdate = rpl->getlastupdate();
+    record.snr = rpl->getSNR();
+    record.snrInst = round(rpl->getsnr_inst()*100)/100.0;
+    record.rxRate = round(linkMetrics.getRxFrameRate()*100.0)/100.0;
+    PacketTrace::getInstance().record(record);
+
+    FeatureExport& featureExport = FeatureExport::getInstance();
+    if (featureExport.isEnabled()) {
+        FeatureRecord features;
+        features.time = simTime();
+        features.node = record.node;
+        features.packet = record.packet;
+        rpl->getLinkFeatures(features);
+        featureExport.recordHop(features);
+    }
 
 }
 
@@ -68,11 +68,9 @@ class INET_API UdpBasicApp : public ApplicationBase, public UdpSocket::ICallback
     int numReceived = 0;
 
     //To get variables from L2   CL 2021-11-09
-    cModule *macModule = nullptr;
     Ieee802154Mac *mac = nullptr;
 
     //To get variables from Rpl module   CL 2021-12-10
-    cModule *rplModule = nullptr;
     Rpl *rpl = nullptr;
 
     //To get variables form Radio module CL 2022-09-12
@@ -19,6 +19,8 @@
 #include "inet/common/ModuleAccess.h"
 #include "inet/common/packet/Packet.h"
 #include "inet/networklayer/common/L3AddressResolver.h"
+#include "inet/routing/rpl/FeatureExport.h"
+#include "inet/routing/rpl/PacketTrace.h"
 #include "inet/transportlayer/contract/udp/UdpControlInfo_m.h"
 
 #include <iostream>
@@ -158,12 +160,8 @@ void UdpSink::processPacket(Packet *pk)
         L3Address src = pk->getTag<L3AddressInd>()->getSrcAddress();
         int hop = pk->getTag<HopLimitInd>()->getHopLimit();
         hop = 32 - hop + 1; //Based on initial TTL=32. Also, +1 b/c IP does not decrement in the first hop, but does not forward with TTL =1
-        std::ofstream file;
-        file.open("St_deviceID.txt", std::ios_base::app);
-        file << src << " "<< hop << endl;
-        file.close();
+        TraceSink::line("St_deviceID.txt") << src << " "<< hop << endl;
     //Record the packet when arrives to the destination
-        file.open("St_packet-tracer.txt", std::ios_base::app);
         std::string packetName = pk->getName();
         int packetSize = pk->getByteLength();
 
@@ -180,14 +178,14 @@ void UdpSink::processPacket(Packet *pk)
  */
    //     file << simTime() <<" " <<getParentModule()->getFullName() << " pkt_rcv " << packetName << endl;
 
-        file << simTime() <<" " << getParentModule()->getFullName() << " pkt_rcv " << packetName <<" " <<
-                 "0" << " " << "0" << " " << "0"<< " " << "0" << " " <<
-                 "0" << " " << "0" << " " << "0" << " " << "0" << " " <<
-                 "0" << " " << "0" << " " << "0" << " " << "0" << " " <<
-                 "0" << " " << "0" << " " << "0" << " " << "0" << " " << "0" << " " << "0" << " "
-                 "0" << " " << "0" << endl ;
-
-        file.close();
+        // all metric columns stay 0 for received packets
+        PacketTraceRecord record;
+        record.time = simTime();
+        record.node = getParentModule()->getFullName();
+        record.event = "pkt_rcv";
+        record.packet = packetName.c_str();
+        PacketTrace::getInstance().record(record);
+        FeatureExport::getInstance().recordDelivery(packetName.c_str());
 
     delete pk;
 
@@ -32,11 +32,14 @@
 #include "inet/common/ModuleAccess.h"
 #include "inet/common/ProtocolGroup.h"
 #include "inet/common/ProtocolTag_m.h"
+#include "inet/common/Simsignals.h"
 #include "inet/linklayer/common/InterfaceTag_m.h"
 #include "inet/linklayer/common/MacAddressTag_m.h"
 #include "inet/linklayer/ieee802154/Ieee802154Mac.h"
 #include "inet/linklayer/ieee802154/Ieee802154MacHeader_m.h"
 #include "inet/networklayer/common/InterfaceEntry.h"
+#include "inet/routing/rpl/HostBindings.h"
+#include "inet/routing/rpl/TraceSink.h"
 
 #include <fstream>
 #include <iostream>
@@ -48,11 +51,15 @@ using namespace physicallayer;
 
 Define_Module(Ieee802154Mac);
 
+simsignal_t Ieee802154Mac::linkEtxSignal = registerSignal("linkEtx");
+simsignal_t Ieee802154Mac::linkMetricsChangedSignal = registerSignal("linkMetricsChanged");
+
 void Ieee802154Mac::initialize(int stage)
 {
     MacProtocolBase::initialize(stage);
     if (stage == INITSTAGE_LOCAL) {
         useMACAcks = par("useMACAcks");
+        neighborLinks.setHalfLife(par("linkQualityHalfLife"));
         sifs = par("sifs");
         headerLength = par("headerLength");
         transmissionAttemptInterruptedByRx = false;
@@ -81,8 +88,6 @@ void Ieee802154Mac::initialize(int stage)
               // linkBroken.setName("Data Packet losses by limit retry reached");
                //reception_errors.setName("Reception errors");
 
-               framedropbyretry_limit_reached = 0;  //Changed 2022-01-26
-               framedropbycongestion =0;
                //droppingbybiterrors=0;
        //end CL
 
@@ -118,8 +123,12 @@ void Ieee802154Mac::initialize(int stage)
         macState = IDLE_1;
         txAttempts = 0;
         txQueue = check_and_cast<queueing::IPacketQueue *>(getSubmodule("queue"));
-        channel_util_mess = new cMessage("check channel utilization");  //CL 2022-02-19
-        scheduleAt(simTime() + 5, channel_util_mess);
+        //CL 2022-02-19: the queue utilization follows every change of the queue length
+        cModule *queueModule = getSubmodule("queue");
+        queueModule->subscribe(packetPushEndedSignal, this);
+        queueModule->subscribe(packetPulledSignal, this);
+        queueModule->subscribe(packetRemovedSignal, this);
+        queueModule->subscribe(packetDroppedSignal, this);
         fail_rate_mess = new cMessage("fail rate calculation"); //CL 2022-10-03
         scheduleAt(simTime() + 2, fail_rate_mess);
     }
@@ -127,7 +136,10 @@ void Ieee802154Mac::initialize(int stage)
         cModule *radioModule = getModuleFromPar<cModule>(par("radioModule"), this);
         radioModule->subscribe(IRadio::radioModeChangedSignal, this);
         radioModule->subscribe(IRadio::transmissionStateChangedSignal, this);
+        radioModule->subscribe(IRadio::receptionStateChangedSignal, this);
         radio = check_and_cast<IRadio *>(radioModule);
+        linkMetrics.recordChannelState(radio->getReceptionState() != IRadio::RECEPTION_STATE_IDLE);
+        phy = HostBindings::get(this)->getRadio();    // bound once instead of looked up per received frame
 
         //check parameters for consistency
         //aTurnaroundTime should match (be equal or bigger) the RX to TX
@@ -169,20 +181,11 @@ void Ieee802154Mac::finish()
     recordScalar("backoffDurations", backoffValues);
 
     //CL on 2021-01-27....to save data of packet losses
-        std:: ofstream file;
-        file.open("St_packet_Losses_by_backoff_limit_reached.txt", std::ios_base::app);
-        file << getParentModule()->getParentModule()->getFullName() <<" " <<framedropbycongestion_copy  <<endl;
-        file.close();
-
-        file.open("St_packet_Losses_by_retry_tx_limit_reached.txt", std::ios_base::app);
-        file << getParentModule()->getParentModule()->getFullName() <<" "<< framedropbyretry_limit_reached_copy  <<endl;
-        file.close();
-
-    //CL on 2022-01-31 .... to see the content of countercacheL2
-        //file.open("St_ACKvalues.txt", std::ios_base::app);
-        //file << getParentModule()->getParentModule()->getFullName() <<" :" <<endl;
-        printCacheL2();
-        //file.close();
+    recordScalar("framesDroppedByBackoffLimit", framedropbycongestion_copy);
+    recordScalar("framesDroppedByRetryLimit", framedropbyretry_limit_reached_copy);
+
+    //CL on 2022-01-31 .... to see the content of neighborLinks
+    recordLinkStatistics();
 }
 
 Ieee802154Mac::~Ieee802154Mac()
@@ -191,7 +194,6 @@ Ieee802154Mac::~Ieee802154Mac()
     cancelAndDelete(ccaTimer);
     cancelAndDelete(sifsTimer);
     cancelAndDelete(rxAckTimer);
-    cancelAndDelete(channel_util_mess);  //CL 2022-02-20
     cancelAndDelete(fail_rate_mess);
     if (ackMessage)
         delete ackMessage;
@@ -284,7 +286,7 @@ void Ieee802154Mac::updateStatusIdle(t_mac_event event, cMessage *msg)
             decapsulate(check_and_cast<Packet *>(msg));
             sendUp(msg);
             nbRxFrames++;
-            nbRxFrames_copy++; //CL 2021-11-09
+            linkMetrics.recordRxFrame(); //CL 2021-11-09
 
             if (useMACAcks) {
                 radio->setRadioMode(IRadio::RADIO_MODE_TRANSMITTER);
@@ -296,7 +298,7 @@ void Ieee802154Mac::updateStatusIdle(t_mac_event event, cMessage *msg)
         case EV_BROADCAST_RECEIVED:
             EV_DETAIL << "(23) FSM State IDLE_1, EV_BROADCAST_RECEIVED: Nothing to do." << endl;
             nbRxFrames++;
-            nbRxFrames_copy++; //CL
+            linkMetrics.recordRxFrame(); //CL
             decapsulate(check_and_cast<Packet *>(msg));
             sendUp(msg);
             break;
@@ -397,8 +399,7 @@ void Ieee802154Mac::updateStatusCCA(t_mac_event event, cMessage *msg)
                 // give time for the radio to be in Tx state before transmitting
                 sendDelayed(mac, aTurnaroundTime, lowerLayerOutGateId);
                 nbTxFrames++;
-                nbTxFrames_copy++; //CL 2021-11-09
-                EV_INFO << "nbTxFramenb_copy = " << nbTxFrames_copy << endl;
+                linkMetrics.recordTxFrame(); //CL 2021-11-09
                 EV_INFO << "nbTxFramenb = " << nbTxFrames << endl;
             }
             else {
@@ -407,7 +408,7 @@ void Ieee802154Mac::updateStatusCCA(t_mac_event event, cMessage *msg)
                           << " increment counters." << endl;
                 NB = NB + 1;
                 //BE = std::min(BE+1, macMaxBE);
-                NB_copy = NB_copy + 1; //CL 2022-10-03
+                linkMetrics.recordBackoff(); //CL 2022-10-03
 
                 // decide if we go for another backoff or if we drop the frame.
                 if (NB > macMaxCSMABackoffs) {
@@ -434,17 +435,14 @@ void Ieee802154Mac::updateStatusCCA(t_mac_event event, cMessage *msg)
                     txAttempts = 0;
                     if (currentTxFrame) {
                         nbDroppedFrames++;
-                        framedropbycongestion++; //nbDroppedFrames_copy++; //CL
+                        linkMetrics.recordCongestionDrop(); //nbDroppedFrames_copy++; //CL
                         framedropbycongestion_copy++;
                         PacketDropDetails details;
                         details.setReason(CONGESTION);
                         details.setLimit(macMaxCSMABackoffs);
                         dropCurrentTxFrame(details);
                         //for more details: 10/12/2022
-                        std:: ofstream file;
-                        file.open("St_packet_Losses_by_backoff_limit_reached_details.txt", std::ios_base::app);
-                        file << "time: " << simTime() << " " << getParentModule()->getParentModule()->getFullName() <<" " <<framedropbycongestion_copy << endl;
-                        file.close();
+                        TraceSink::line("St_packet_Losses_by_backoff_limit_reached_details.txt") << "time: " << simTime() << " " << getParentModule()->getParentModule()->getFullName() <<" " <<framedropbycongestion_copy << endl;
 
                     }
                     else {
@@ -597,7 +595,7 @@ void Ieee802154Mac::manageMissingAck(t_mac_event    /*event*/, cMessage *msg
     if (txAttempts < macMaxFrameRetries) {
         // increment counter
         txAttempts++;
-        txAttempts_copy = txAttempts_copy + 1; //2022-10-03
+        linkMetrics.recordRetry(); //2022-10-03
         EV_DETAIL << "I will retransmit this packet (I already tried "
                   << txAttempts << " times)." << endl;
 
@@ -608,33 +606,12 @@ void Ieee802154Mac::manageMissingAck(t_mac_event    /*event*/, cMessage *msg
         const auto& csmaHeader = currentTxFrame->peekAtFront<Ieee802154MacHeader>();
         EV_INFO << "I lost an ACK from: " << csmaHeader->getDestAddr() << endl;
 
-        std::vector<ParentStructure*>::iterator it;
-        for(it = countercache_L2.begin(); it != countercache_L2.end(); it++)
-        {
-            if(csmaHeader->getDestAddr() == (*it)->SenderMacAddr){
-              (*it)->ACKMissedcounter = (*it)->ACKMissedcounter + 1;
-              EV_INFO <<"MAC address of this sender: " << (*it)->SenderMacAddr <<endl;
-              //EV_INFO <<"NodeId of this sender: " << (*it)->nodeId <<endl;
-              EV_INFO <<"Number of ACKs missed from this sender: " << (*it)->ACKMissedcounter <<endl;
-              EV_INFO <<"Number of ACKs received from this sender: " << (*it)->Rcvdcounter <<endl;
-              goto execute_txt;
-            }
-         }
-        if (it == countercache_L2.end()) {
-           ParentStructure* rcv = new ParentStructure();
-           rcv->SenderMacAddr = csmaHeader->getDestAddr();
-           rcv->nodeId = csmaHeader->getDestAddr().getInt();
-           rcv->ACKMissedcounter = 1;
-           countercache_L2.push_back(rcv);
-           EV_INFO <<"first ACK missed from this sender " <<endl;
-           //EV_INFO <<"Number of ACKs received from this sender: " << (*it)->Rcvdcounter <<endl;
-           EV_INFO << "nodeId of this sender: " << rcv->nodeId ;
-        }
+        NeighborLink& link = neighborLinks.get(csmaHeader->getDestAddr());
+        neighborLinks.recordAck(link, false);
+        EV_INFO <<"Number of ACKs missed from this sender: " << link.ackMissed <<endl;
+        EV_INFO <<"Number of ACKs received from this sender: " << link.ackReceived <<endl;
 
-        execute_txt: std:: ofstream file;
-        file.open("St_ACK_drop_detail.txt", std::ios_base::app);
-        file << simTime()<< " " << getParentModule()->getParentModule()->getFullName() <<" missing ACK from: " << csmaHeader->getDestAddr() << endl;
-        file.close();
+        TraceSink::line("St_ACK_drop_detail.txt") << simTime()<< " " << getParentModule()->getParentModule()->getFullName() <<" missing ACK from: " << csmaHeader->getDestAddr() << endl;
         //CL
 
     }
@@ -663,17 +640,13 @@ void Ieee802154Mac::manageMissingAck(t_mac_event    /*event*/, cMessage *msg
         const auto& csmaHeader = currentTxFrame->peekAtFront<Ieee802154MacHeader>();
         EV_INFO << "I lost an ACK from: " << csmaHeader->getDestAddr() << endl;
 
-        std::vector<ParentStructure*>::iterator it;
-        for(it = countercache_L2.begin(); it != countercache_L2.end(); it++)
-        {
-           if(csmaHeader->getDestAddr() == (*it)->SenderMacAddr){
-              (*it)->ACKMissedcounter = (*it)->ACKMissedcounter + 1;
-              EV_INFO <<"Number of ACKs missed from this sender: " << (*it)->ACKMissedcounter <<endl;
-              EV_INFO <<"Number of ACKs received from this sender: " << (*it)->Rcvdcounter <<endl;
-           }
+        if (NeighborLink *link = neighborLinks.find(csmaHeader->getDestAddr().getInt())) {
+            neighborLinks.recordAck(*link, false);
+            EV_INFO <<"Number of ACKs missed from this sender: " << link->ackMissed <<endl;
+            EV_INFO <<"Number of ACKs received from this sender: " << link->ackReceived <<endl;
         }
-       //In this case, the second part of this code is not necessary because to arrive at this point we must have
-       //missed more than macMaxFrameRetries ACKs so the senderMacAddr must be in countercache_L2
+       //In this case, the neighbor doesn't have to be added because to arrive at this point we must have
+       //missed more than macMaxFrameRetries ACKs so the senderMacAddr must be in neighborLinks
 
        //end code added by CL
 
@@ -682,14 +655,11 @@ void Ieee802154Mac::manageMissingAck(t_mac_event    /*event*/, cMessage *msg
         details.setReason(RETRY_LIMIT_REACHED);
         details.setLimit(macMaxFrameRetries);
         dropCurrentTxFrame(details);
-        framedropbyretry_limit_reached++;
+        linkMetrics.recordRetryLimitDrop();
         framedropbyretry_limit_reached_copy++;
 
         //for more details: 10/12/2022
-        std:: ofstream file;
-        file.open("St_packet_Losses_by_retry_limit_reached_details.txt", std::ios_base::app);
-        file << "time: " << simTime() << " " << getParentModule()->getParentModule()->getFullName() <<" " <<framedropbyretry_limit_reached_copy << endl;
-        file.close();
+        TraceSink::line("St_packet_Losses_by_retry_limit_reached_details.txt") << "time: " << simTime() << " " << getParentModule()->getParentModule()->getFullName() <<" " <<framedropbyretry_limit_reached_copy << endl;
 
     }
     manageQueue();
@@ -927,8 +897,6 @@ void Ieee802154Mac::handleSelfMessage(cMessage *msg)
         nbMissedAcks_copy++;
         executeMac(EV_ACK_TIMEOUT, msg);
     }
-    else if (msg == channel_util_mess)          //CL 2022-02-19
-        channel_utilization();
     else if (msg == fail_rate_mess)
         fail_rate();
     else
@@ -943,45 +911,20 @@ void Ieee802154Mac::handleLowerPacket(Packet *packet)
 {
    //to keep record of the signal strength of each neighbor
 
-    radioModule = getParentModule()->getParentModule()->getSubmodule("wlan",0)->getSubmodule("radio");
-    //EV_INFO << "radioModue: " << radioModule << endl;
-    phy = check_and_cast<Radio *>(radioModule);
     EV_INFO << "testing getting radio module from MAC: SNR = " << phy->snr_L1 << endl;
 
     const auto& csmaHeader = packet->peekAtFront<Ieee802154MacHeader>();
     const MacAddress& src = csmaHeader->getSrcAddr();
 
     //CL 2022-10-30
-    std::vector<ParentStructure*>::iterator it;
-    for(it = countercache_L2.begin(); it != countercache_L2.end(); it++) {
-        if(src == (*it)->SenderMacAddr){
-            (*it)->Rcvdcounter_all = (*it)->Rcvdcounter_all + 1;
-            EV_INFO <<"Number of packets received from this sender: " << (*it)->Rcvdcounter_all <<endl;
-            (*it)->snr_rssi = (*it)->snr_rssi + phy->snr_L1 ;
-            (*it)->ave_snr_rssi = (*it)->snr_rssi / (*it)->Rcvdcounter_all ;
-            EV_INFO << "Average SNR of this sender is: " << (*it)->ave_snr_rssi << endl;
-            //return;
-            goto next;
-        }
-    }
-    if (it == countercache_L2.end()) {
-        ParentStructure* rcv = new ParentStructure();
-        rcv->SenderMacAddr = src;
-        rcv->nodeId = src.getInt();
-        rcv->Rcvdcounter_all = 1;
-        countercache_L2.push_back(rcv);
-        EV_INFO <<"first packet received from this sender " <<endl;
-        //EV_INFO <<"Number of ACKs missed from this sender: " << (*it)->ACKMissedcounter  <<endl; //give error
-        //EV_INFO << "nodeId: " << src.getInt() << endl;
-        //2022-10-28
-        rcv->snr_rssi = phy->snr_L1 ;
-        rcv->ave_snr_rssi = (rcv)->snr_rssi ;
-        EV_INFO << "Average SNR of this sender is (1stPkt): " << (rcv)->ave_snr_rssi << endl;
-    }
+    NeighborLink& link = neighborLinks.get(src);
+    neighborLinks.recordFrame(link, phy->snr_L1);
+    EV_INFO <<"Number of packets received from this sender: " << link.framesReceived <<endl;
+    EV_INFO << "Recent average SNR of this sender is: " << link.getSnr() << endl;
 
     //end CL
 
-next: if (packet->hasBitError()) {
+    if (packet->hasBitError()) {
         EV << "Received " << packet << " contains bit errors or collision, dropping it\n";
         PacketDropDetails details;
         details.setReason(INCORRECTLY_RECEIVED);
@@ -1057,39 +1000,12 @@ next: if (packet->hasBitError()) {
                 if (src == csmaHeader->getDestAddr()) {
                     nbRecvdAcks++;
 
-                    //CL 2021-09-11
-                    std::vector<ParentStructure*>::iterator it;
-                    for(it = countercache_L2.begin(); it != countercache_L2.end(); it++)
-                    {
-                         if(src == (*it)->SenderMacAddr){
-                             (*it)->Rcvdcounter = (*it)->Rcvdcounter + 1;
-                              EV_INFO <<"Number of ACKs received from this sender: " << (*it)->Rcvdcounter <<endl;
-                              EV_INFO <<"Number of ACKs missed from this sender: " << (*it)->ACKMissedcounter  <<endl;
-                              //2022-10-28
-                              //(*it)->snr_rssi = (*it)->snr_rssi + radio->snr_L1 ;
-                              //(*it)->ave_snr_rssi = (*it)->snr_rssi / (*it)->Rcvdcounter ;
-                              //EV_INFO << "Average SNR of this sender is: " << (*it)->ave_snr_rssi << endl;
-                              //return;
-                              goto execute_mac;
-                         }
-                     }
-                     if (it == countercache_L2.end()) {
-                         ParentStructure* rcv = new ParentStructure();
-                         rcv->SenderMacAddr = src;
-                         rcv->nodeId = src.getInt();
-                         rcv->Rcvdcounter = 1;
-                         countercache_L2.push_back(rcv);
-                         EV_INFO <<"first ACK received from this sender " <<endl;
-                         //EV_INFO <<"Number of ACKs missed from this sender: " << (*it)->ACKMissedcounter  <<endl; //give error
-                         EV_INFO << "nodeId: " << src.getInt() << endl;
-                         //2022-10-28
-                         //(*it)->snr_rssi = (*it)->snr_rssi + radio->snr_L1 ;
-                         //(*it)->ave_snr_rssi = (*it)->snr_rssi / (*it)->Rcvdcounter ;
-                         //EV_INFO << "Average SNR of this sender is (1stACK): " << (*it)->ave_snr_rssi << endl;
-                     }
+                    //CL 2021-09-11, the sender's entry was looked up above
+                    neighborLinks.recordAck(link, true);
+                    EV_INFO <<"Number of ACKs received from this sender: " << link.ackReceived <<endl;
+                    EV_INFO <<"Number of ACKs missed from this sender: " << link.ackMissed <<endl;
                     //end CL
-                    //executeMac(EV_ACK_RECEIVED, packet);
-                    execute_mac: executeMac(EV_ACK_RECEIVED, packet);
+                    executeMac(EV_ACK_RECEIVED, packet);
                 }
                 else {
                     EV << "Error! Received an ack from an unexpected source: src=" << src << ", I was expecting from node addr=" << csmaHeader->getDestAddr() << endl;
@@ -1125,6 +1041,24 @@ void Ieee802154Mac::receiveSignal(cComponent *source, simsignal_t signalID, intv
         }
         transmissionState = newRadioTransmissionState;
     }
+    else if (signalID == IRadio::receptionStateChangedSignal) {
+        //CL 2022-02-19: the channel counts as busy unless the radio listens to an idle medium
+        if (linkMetrics.recordChannelState(value != IRadio::RECEPTION_STATE_IDLE)) {
+            EV_INFO << "Channel utilization of the last window: " << linkMetrics.getLastChannelUtilization() << endl;
+            emit(linkMetricsChangedSignal, &linkMetrics);
+        }
+    }
+}
+
+void Ieee802154Mac::receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details)
+{
+    Enter_Method_Silent();
+    if (signalID == packetPushEndedSignal || signalID == packetPulledSignal || signalID == packetRemovedSignal || signalID == packetDroppedSignal) {
+        linkMetrics.recordQueueLength(txQueue->getNumPackets());
+        EV_DETAIL << "current queue status: " << txQueue->getNumPackets() << endl;
+    }
+    else
+        MacProtocolBase::receiveSignal(source, signalID, obj, details);
 }
 
 void Ieee802154Mac::decapsulate(Packet *packet)
@@ -1140,132 +1074,37 @@ void Ieee802154Mac::decapsulate(Packet *packet)
 //CL  2022-01-28
 double Ieee802154Mac::getACKrcv (uint64_t nodeId)
 {
-    uint64_t srcId = nodeId;
-
-    std::vector<ParentStructure*>::iterator it;
-    for(it = countercache_L2.begin(); it != countercache_L2.end(); it++)
-    {
-       if(srcId == (*it)->nodeId){
-           //EV_INFO << "macAddress of this sender: " << (*it)->SenderMacAddr << endl;
-           //EV_INFO <<"Number of ACKs received from this sender: " << (*it)->Rcvdcounter <<endl;
-           //EV_INFO <<"Number of ACKs missed from this sender: " << (*it)->ACKMissedcounter  <<endl;
-           return (*it)->Rcvdcounter;
-       }
-    }
-    if (it == countercache_L2.end())
-        return 0;
+    const NeighborLink *link = neighborLinks.find(nodeId);
+    return link ? link->ackReceived : 0;
 }
 
-
 double Ieee802154Mac::getACKmissed (uint64_t nodeId)
 {
-    uint64_t srcId = nodeId;
-
-        std::vector<ParentStructure*>::iterator it;
-        for(it = countercache_L2.begin(); it != countercache_L2.end(); it++)
-        {
-           if(srcId == (*it)->nodeId){
-               //EV_INFO << "macAddress of this sender: " << (*it)->SenderMacAddr << endl;
-               //EV_INFO <<"Number of ACKs received from this sender: " << (*it)->Rcvdcounter <<endl;
-               //EV_INFO <<"Number of ACKs missed from this sender: " << (*it)->ACKMissedcounter  <<endl;
-               return (*it)->ACKMissedcounter ;
-           }
-        }
-        if (it == countercache_L2.end())
-            return 0;
-
+    const NeighborLink *link = neighborLinks.find(nodeId);
+    return link ? link->ackMissed : 0;
 }
 
-void Ieee802154Mac::printCacheL2(){
-
-    //CL on 2022-01-31 .... to see the content of countercacheL2
-    std:: ofstream file;
-    file.open("St_ACKvalues.txt", std::ios_base::app);
-    file << getParentModule()->getParentModule()->getFullName() <<" :" <<endl;
-    //file << printCacheL2()<< endl;
-    //file.close();
-
-    std::vector<ParentStructure*>::iterator it;
-    for(it = countercache_L2.begin(); it != countercache_L2.end(); it++)
-    {
-       file <<"sender MacAddress: " << (*it)->SenderMacAddr << endl;
-       file <<"Number of ACKs received from this sender: " << (*it)->Rcvdcounter <<endl;
-       file <<"Number of ACKs missed from this sender: " << (*it)->ACKMissedcounter  <<endl;
-       file <<"etx = " << (((*it)->Rcvdcounter + (*it)->ACKMissedcounter )/(*it)->Rcvdcounter) <<endl;
-       file << "-----------------------------------" << endl;
-
+void Ieee802154Mac::recordLinkStatistics(){
 
+    //CL on 2022-01-31 .... ETX of every neighbor we got an ACK from, recorded as histogram (see linkEtx in the NED)
+    for (const NeighborLink& link : neighborLinks) {
+       EV_DETAIL << "sender MacAddress: " << link.address
+                 << ", ACKs received: " << link.ackReceived
+                 << ", ACKs missed: " << link.ackMissed << endl;
+       if (link.ackReceived > 0)
+           emit(linkEtxSignal, (link.ackReceived + link.ackMissed) / link.ackReceived);
     }
-    file.close();
-}
-
-void Ieee802154Mac::channel_utilization(){
-
-    scheduleAt(simTime() + 1 , channel_util_mess);
-        //get if the channel is busy or idle
-        bool isIdle = radio->getReceptionState() == IRadio::RECEPTION_STATE_IDLE;
-        //channel_util = (1 - isIdle)*0.6 + (1-0.6)*(channel_util); //because idle = 1 and busy = 0, so I want utilization [0-1]
-        EV_INFO << "current channel status: " << isIdle << endl;
-
-        if (isIdle == 0)
-            busy = busy + 1;
-        else
-            idle = idle + 1;
-
-        //channel_util = busy/(busy + idle);
-        EV_INFO << "Amount of sample busy: " << busy << endl;
-        EV_INFO << "Amount of sample idle: " << idle << endl;
-        //EV_INFO << "I am updating channel utilization: " << channel_util << endl;
-
-        //to reset the channel utilization every 10 min:
-        if ((busy + idle) == 600){
-            channel_util = busy/(busy + idle);
-            busy = 0;
-            idle = 0;
-            last_ch_uti_reset = simTime();
-        }
-
-    //queue utilization
-    int pkt_in_queue = txQueue->getNumPackets();
-    qu = 0.8*(pkt_in_queue) + 0.2*(qu) ;
-    EV_INFO << "current queue status: " << pkt_in_queue << endl;
-    EV_INFO << "I am updating queue utilization: " << qu << endl;
-
 }
 
 void Ieee802154Mac::fail_rate(){
 
     scheduleAt (simTime() + 600, fail_rate_mess);
 
-    if (nbTxFrames_copy + txAttempts_copy == 0){
-        fail_rate_retry = 0 ;
-        EV_INFO << "Fail Rate by retry: " << fail_rate_retry << " ...NO Tx frames in the period" << endl;
-    } else {
-        fail_rate_retry = (framedropbyretry_limit_reached + txAttempts_copy)/(nbTxFrames_copy + txAttempts_copy) ;
-        EV_INFO << "Fail Rate by retry: " << fail_rate_retry << endl;
-    }
-
-    //TODO the same for congestion
-
-    if (nbTxFrames_copy + txAttempts_copy + NB_copy  == 0){
-        fail_rate_cong = 0 ;
-        EV_INFO << "Drop Rate for Cong: " << fail_rate_cong << " ...NO Tx frames in the period" << endl;
-     } else {
-        fail_rate_cong = (framedropbycongestion + txAttempts_copy + NB_copy)/(nbTxFrames_copy + txAttempts_copy + NB_copy) ;
-        EV_INFO << "Fail Rate by congestion: " << fail_rate_cong << endl;
-     }
-
-    //New metric rx_rate:    11/05/2022
-    rx_frames_rate = nbRxFrames_copy ;
-
-    framedropbycongestion = 0;
-    framedropbyretry_limit_reached = 0;
-    nbTxFrames_copy = 0;
-    txAttempts_copy = 0;
-    NB_copy = 0;
-    last_reading = simTime();
-    nbRxFrames_copy = 0;
-
+    //the rates (and the rx frames, new metric 11/05/2022) of this period become the long-term part of the estimators
+    linkMetrics.closePeriod();
+    EV_INFO << "Fail Rate by retry: " << linkMetrics.getLastFailRateRetry() << endl;
+    EV_INFO << "Fail Rate by congestion: " << linkMetrics.getLastFailRateCong() << endl;
+    emit(linkMetricsChangedSignal, &linkMetrics);
 }
 
 //2022-02-22: To get MAC address based on IPaddres, the idea is:
@@ -1280,23 +1119,9 @@ uint64_t Ieee802154Mac::IPfromUpperLayers(MacAddress macAddr)
 
 double Ieee802154Mac::getSNRave (uint64_t nodeId)   //To get AVE SNR
 {
-    uint64_t srcId = nodeId;
-
-        std::vector<ParentStructure*>::iterator it;
-        for(it = countercache_L2.begin(); it != countercache_L2.end(); it++)
-        {
-           if(srcId == (*it)->nodeId){
-               //EV_INFO << "macAddress of this sender: " << (*it)->SenderMacAddr << endl;
-               //EV_INFO <<"Number of ACKs received from this sender: " << (*it)->Rcvdcounter <<endl;
-               //EV_INFO <<"Number of ACKs missed from this sender: " << (*it)->ACKMissedcounter  <<endl;
-               return (*it)->ave_snr_rssi ;
-           }
-        }
-        if (it == countercache_L2.end())
-            return 0;
-
+    const NeighborLink *link = neighborLinks.find(nodeId);
+    return link ? link->getSnr() : 0;
 }
 
-
 } // namespace inet
 
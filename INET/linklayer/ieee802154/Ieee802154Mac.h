@@ -31,6 +31,8 @@
 #include "inet/linklayer/base/MacProtocolBase.h"
 #include "inet/linklayer/common/MacAddress.h"
 #include "inet/linklayer/contract/IMacProtocol.h"
+#include "inet/linklayer/ieee802154/LinkMetrics.h"
+#include "inet/linklayer/ieee802154/NeighborLinkTable.h"
 #include "inet/physicallayer/contract/packetlevel/IRadio.h"
 
 #include "inet/physicallayer/common/packetlevel/Radio.h"  //added by CL to read in radio layer
@@ -97,31 +99,19 @@ class INET_API Ieee802154Mac : public MacProtocolBase, public IMacProtocol
     {}
 
     //CL 2021-09-11
-        struct ParentStructure {         //it is necessary for ETX to keep record of received ack from every neighbor
-               Ipv6Address SenderIpAddr;
-               MacAddress SenderMacAddr;
-               uint64_t nodeId;  //Node's MAC converted in decimal
-               double Rcvdcounter = 0;  //ACKs received from a specific sender
-               double ACKMissedcounter = 0; //ACKs missed from a specific sender
-               //The idea is that the amount of ACKs transmitted by a specific sender is: Rcvdcounter + ACKMissedcounter
-               double Rcvdcounter_all = 0;
-               double snr_rssi = 0; //accumulative
-               double ave_snr_rssi = 0; //to average the snr from ACK sender
-               };
-        typedef std::vector<ParentStructure*> CounterCache;
-                CounterCache countercache_L2;
-
-       //Method to get into ParentStructure from OF
+        //ACKs and received frames of every neighbor, for the on-link ETX and SNR
+        NeighborLinkTable neighborLinks;
+        const NeighborLinkTable& getNeighborLinks() const { return neighborLinks; }
+
+       //Method to get into the neighbor links from OF
        double getACKrcv (uint64_t nodeId);
        double getACKmissed (uint64_t nodeId);
-       virtual void printCacheL2(); //2022-01-31
+       virtual void recordLinkStatistics(); //2022-01-31, emits the per-neighbor ETX in finish()
 
        double getSNRave (uint64_t nodeId) ; //2022-10-30
 
        //Variables that I want to have access from other layers
 
-        int nbTxFrames_copy = 0;
-        int nbRxFrames_copy = 0;
         int nbMissedAcks_copy = 0;
        // int nbRecvdAcks_copy = 0;
         int nbDroppedFrames_copy = 0;
@@ -129,38 +119,25 @@ class INET_API Ieee802154Mac : public MacProtocolBase, public IMacProtocol
        // int nbDuplicates_copy = 0;
        // int nbBackoffs_copy = 0;
        // int backoffValues_copy = 0;
-        double rx_frames_rate = 0;
-
-        int framedropbyretry_limit_reached = 0; //means the pkt was trasnmitted but the ACK never was received
-        int framedropbycongestion = 0; //means the channel was busy at the time of transmitting. It is incremented exactly
-                                       // where nbDroppedFrames is incremented
-        int framedropbyretry_limit_reached_copy = 0;
+        int framedropbyretry_limit_reached_copy = 0; //means the pkt was trasnmitted but the ACK never was received
         int framedropbycongestion_copy = 0;
 
-        double channel_util = 0;    //Channel utilization metric.   2022-02-19
-        virtual void channel_utilization();
-        cMessage *channel_util_mess ;
-        double qu = 0; //queue utilization. I'll update it together with channel util to avoid complexity
-                       //in fact, this metric according the way I am calculating it, is more "pkt/s in the queue"
+        //Fail rates, rx frames and channel utilization (2022-02-19, 2022-10-03), updated on every counter change
+        LinkMetrics linkMetrics;
+        const LinkMetrics& getLinkMetrics() const { return linkMetrics; }
+
+        //channel and queue utilization (2022-02-19) are kept in linkMetrics from the radio's reception state
+        //and the queue's push/pull signals, see LinkMetrics::getChannelUtilization() and getQueueUtilization()
 
-        double busy = 0; //to count busy and idle stage  22-10-20
-        double idle = 0;
 
         uint64_t IPfromUpperLayers(MacAddress macAddr);
 
         // 2022-10-03
-        double fail_rate_retry = 0;
-        double fail_rate_cong = 0;
         virtual void fail_rate();
         cMessage *fail_rate_mess ;
-        double txAttempts_copy = 0;
-        double NB_copy = 0;
-        simtime_t last_reading = 0;
-        simtime_t last_ch_uti_reset = 0;
         //double rx_suc_rate = 0; //try to get it from the radio layer
 
         //To get variables from L1   CL 2022-10-29
-        cModule *radioModule = nullptr;
         Radio *phy = nullptr;
         //cModule *host;
 /*
@@ -198,6 +175,10 @@ class INET_API Ieee802154Mac : public MacProtocolBase, public IMacProtocol
 
     /** @brief Handle control messages from lower layer */
     virtual void receiveSignal(cComponent *source, simsignal_t signalID, intval_t value, cObject *details) override;
+    virtual void receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj, cObject *details) override;
+
+    static simsignal_t linkEtxSignal;
+    static simsignal_t linkMetricsChangedSignal;    // emitted with the LinkMetrics when a period closes or a channel state change finds a closed window
 
   protected:
     /** @name Different tracked statistics.*/
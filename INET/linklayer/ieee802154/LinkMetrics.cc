@@ -0,0 +1,123 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include <cmath>
+#include <sstream>
+
+#include "inet/linklayer/ieee802154/LinkMetrics.h"
+
+namespace inet {
+
+constexpr double LinkMetrics::CHANNEL_WINDOW;
+constexpr double LinkMetrics::QUEUE_DECAY;
+
+void LinkMetrics::updateFailRates()
+{
+    // a retry counts both as an attempt and as a failure
+    int retryAttempts = txFrames + retries;
+    failRateRetry = retryAttempts == 0 ? 0 : (double)(retryLimitDrops + retries) / retryAttempts;
+    int congAttempts = txFrames + retries + backoffs;
+    failRateCong = congAttempts == 0 ? 0 : (double)(congestionDrops + retries + backoffs) / congAttempts;
+}
+
+bool LinkMetrics::closeChannelWindows(ChannelWindow& window, simtime_t now) const
+{
+    simtime_t end = window.start + CHANNEL_WINDOW;
+    if (now < end)
+        return false;
+    if (channelBusy)
+        window.busyTime += end - window.accounted;
+    window.lastUtil = window.busyTime.dbl() / CHANNEL_WINDOW;
+    if (now >= end + CHANNEL_WINDOW) {
+        // whole windows passed without a state change, the last of them was busy or idle throughout
+        end += CHANNEL_WINDOW * floor((now - end).dbl() / CHANNEL_WINDOW);
+        window.lastUtil = channelBusy ? 1 : 0;
+    }
+    window.start = window.accounted = end;
+    window.busyTime = 0;
+    return true;
+}
+
+LinkMetrics::ChannelWindow LinkMetrics::getChannelWindow() const
+{
+    ChannelWindow window = channelWindow;
+    closeChannelWindows(window, simTime());
+    return window;
+}
+
+bool LinkMetrics::recordChannelState(bool busy)
+{
+    simtime_t now = simTime();
+    bool closed = closeChannelWindows(channelWindow, now);
+    if (channelBusy)
+        channelWindow.busyTime += now - channelWindow.accounted;
+    channelWindow.accounted = now;
+    channelBusy = busy;
+    return closed;
+}
+
+simtime_t LinkMetrics::getChannelBusyTime() const
+{
+    ChannelWindow window = getChannelWindow();
+    return window.busyTime + (channelBusy ? simTime() - window.accounted : SIMTIME_ZERO);
+}
+
+void LinkMetrics::recordQueueLength(int length)
+{
+    queueUtil = getQueueUtilization();
+    queueLength = length;
+    queueSince = simTime();
+}
+
+double LinkMetrics::getQueueUtilization() const
+{
+    // the smoothed value approaches the current length by QUEUE_DECAY per second
+    return queueLength + (queueUtil - queueLength) * pow(QUEUE_DECAY, (simTime() - queueSince).dbl());
+}
+
+void LinkMetrics::closePeriod()
+{
+    lastFailRateRetry = failRateRetry;
+    lastFailRateCong = failRateCong;
+    lastRxFrames = rxFrames;
+    txFrames = rxFrames = retries = backoffs = retryLimitDrops = congestionDrops = 0;
+    failRateRetry = failRateCong = 0;
+    periodStart = simTime();
+}
+
+double LinkMetrics::blend(double current, double previous, simtime_t since)
+{
+    double beta = simTime() - since > 300 ? 0.9 : 0.6;
+    return beta * current + (1 - beta) * previous;
+}
+
+double LinkMetrics::getChannelUtilization(double unsampled) const
+{
+    ChannelWindow window = getChannelWindow();
+    simtime_t elapsed = simTime() - window.start;
+    double current = elapsed == 0 ? unsampled : (getChannelBusyTime() / elapsed);
+    return blend(current, window.lastUtil, window.start);
+}
+
+std::string LinkMetrics::str() const
+{
+    std::ostringstream out;
+    out << "failRateRetry = " << getFailRateRetry() << ", failRateCong = " << getFailRateCong()
+        << ", rxFrameRate = " << getRxFrameRate() << ", channelUtil = " << getChannelUtilization()
+        << ", queueUtil = " << getQueueUtilization();
+    return out.str();
+}
+
+} // namespace inet
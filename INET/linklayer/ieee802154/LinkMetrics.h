@@ -0,0 +1,139 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_LINKMETRICS_H
+#define __INET_LINKMETRICS_H
+
+#include "inet/common/INETDefs.h"
+
+namespace inet {
+
+/**
+ * Local link-quality estimators of the 802.15.4 MAC (fail rate by retries,
+ * fail rate by congestion, received frames, channel utilization and queue
+ * utilization), shared by RPL, the objective function, Ipv6 and the applications.
+ *
+ * The MAC reports every counter change, which refreshes the ratio of the
+ * current measurement period right away. The getters then only blend that
+ * ratio with the one of the last closed period, weighting the current period
+ * 0.6 during its first 300 s and 0.9 afterwards, so reading them is O(1).
+ *
+ * Fail rates are measured over the periods closed by closePeriod(), channel
+ * utilization over windows of CHANNEL_WINDOW seconds. The MAC reports every
+ * change of the channel state and of the queue length, the busy time and the
+ * smoothed queue length up to now are computed when they are read, so
+ * neither needs a periodic timer.
+ */
+class INET_API LinkMetrics : public cObject
+{
+  private:
+    // counters of the current period
+    int txFrames = 0;
+    int rxFrames = 0;
+    int retries = 0;
+    int backoffs = 0;
+    int retryLimitDrops = 0;
+    int congestionDrops = 0;
+    simtime_t periodStart;
+
+    // current channel window; its busy time is counted up to 'accounted', the state held since then is added on read
+    struct ChannelWindow
+    {
+        simtime_t start;
+        simtime_t accounted;
+        simtime_t busyTime;
+        double lastUtil = 0;    // utilization of the last closed window
+    };
+    ChannelWindow channelWindow;
+    bool channelBusy = false;
+
+    // queue length since queueSince, and its smoothed value at that time
+    int queueLength = 0;
+    double queueUtil = 0;
+    simtime_t queueSince;
+
+    // ratios of the current period and window, kept up to date by the counters
+    double failRateRetry = 0;
+    double failRateCong = 0;
+
+    // values of the last closed period and window
+    double lastFailRateRetry = 0;
+    double lastFailRateCong = 0;
+    double lastRxFrames = 0;
+
+    void updateFailRates();
+
+    /** Close the windows of @param window that ended before @param now, @return true if any did */
+    bool closeChannelWindows(ChannelWindow& window, simtime_t now) const;
+
+    /** @return @param window brought up to now by closeChannelWindows() */
+    ChannelWindow getChannelWindow() const;
+
+  public:
+    static constexpr double CHANNEL_WINDOW = 600;    // seconds
+    static constexpr double QUEUE_DECAY = 0.2;       // weight left to the smoothed queue length after a second
+
+    /** Counter updates, called by the MAC */
+    void recordTxFrame() { txFrames++; updateFailRates(); }
+    void recordRxFrame() { rxFrames++; }
+    void recordRetry() { retries++; updateFailRates(); }
+    void recordBackoff() { backoffs++; updateFailRates(); }
+    void recordRetryLimitDrop() { retryLimitDrops++; updateFailRates(); }
+    void recordCongestionDrop() { congestionDrops++; updateFailRates(); }
+
+    /** The channel turned busy or idle, @return true if a channel window closed since the last change */
+    bool recordChannelState(bool busy);
+
+    /** The transmit queue now holds @param length packets */
+    void recordQueueLength(int length);
+
+    /** Close the current fail rate period, its rates become the long-term part of the blends */
+    void closePeriod();
+
+    /**
+     * Blend @param current with @param previous, weighting the current value
+     * more once the period that started at @param since has run for 300 s
+     */
+    static double blend(double current, double previous, simtime_t since);
+
+    /** Blend a metric measured over the fail rate periods, e.g. from the radio */
+    double blendWithPeriod(double current, double previous) const { return blend(current, previous, periodStart); }
+
+    double getFailRateRetry() const { return blendWithPeriod(failRateRetry, lastFailRateRetry); }
+    double getFailRateCong() const { return blendWithPeriod(failRateCong, lastFailRateCong); }
+    double getRxFrameRate() const { return blendWithPeriod(rxFrames, lastRxFrames); }
+
+    /** @param unsampled is taken as the current utilization at the very start of a window */
+    double getChannelUtilization(double unsampled = 0) const;
+
+    /**
+     * @return queue length smoothed like an EWMA of one-second samples with
+     * weight 1 - QUEUE_DECAY on the newest, but over the exact queue history
+     */
+    double getQueueUtilization() const;
+
+    double getLastFailRateRetry() const { return lastFailRateRetry; }
+    double getLastFailRateCong() const { return lastFailRateCong; }
+    double getLastChannelUtilization() const { return getChannelWindow().lastUtil; }
+
+    /** @return time the channel was busy in the current window so far */
+    simtime_t getChannelBusyTime() const;
+
+    virtual std::string str() const override;
+};
+
+} // namespace inet
+
+#endif
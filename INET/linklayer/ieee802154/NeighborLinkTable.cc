@@ -0,0 +1,78 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "inet/linklayer/ieee802154/NeighborLinkTable.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace inet {
+
+constexpr double NeighborLink::MAX_ETX;
+
+double NeighborLink::getEtx() const
+{
+    if (ackReceived + ackMissed == 0)
+        return 1;
+    // after a sample at least one of the recent counts is positive, the received one underflows to 0 after long losses
+    if (recentAckReceived == 0)
+        return MAX_ETX;
+    return std::min(MAX_ETX, (recentAckReceived + recentAckMissed) / recentAckReceived);
+}
+
+const NeighborLink *NeighborLinkTable::find(uint64_t nodeId) const
+{
+    auto it = index.find(nodeId);
+    return it == index.end() ? nullptr : &links[it->second];
+}
+
+NeighborLink& NeighborLinkTable::get(const MacAddress& address)
+{
+    auto inserted = index.emplace(address.getInt(), links.size());
+    if (inserted.second) {
+        links.emplace_back();
+        links.back().address = address;
+    }
+    return links[inserted.first->second];
+}
+
+double NeighborLinkTable::decay(simtime_t& last) const
+{
+    simtime_t now = simTime();
+    double weight = halfLife > 0 ? std::exp2(-(now - last) / halfLife) : 1;
+    last = now;
+    return weight;
+}
+
+void NeighborLinkTable::recordAck(NeighborLink& link, bool acked)
+{
+    double weight = decay(link.lastAck);
+    link.recentAckReceived = link.recentAckReceived * weight + (acked ? 1 : 0);
+    link.recentAckMissed = link.recentAckMissed * weight + (acked ? 0 : 1);
+    if (acked)
+        link.ackReceived++;
+    else
+        link.ackMissed++;
+}
+
+void NeighborLinkTable::recordFrame(NeighborLink& link, double snr)
+{
+    double weight = decay(link.lastFrame);
+    link.recentFrames = link.recentFrames * weight + 1;
+    link.recentSnrSum = link.recentSnrSum * weight + snr;
+    link.framesReceived++;
+}
+
+} // namespace inet
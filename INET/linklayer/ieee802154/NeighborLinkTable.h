@@ -0,0 +1,110 @@
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program; if not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef __INET_NEIGHBORLINKTABLE_H
+#define __INET_NEIGHBORLINKTABLE_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "inet/common/INETDefs.h"
+#include "inet/linklayer/common/MacAddress.h"
+
+namespace inet {
+
+/**
+ * What the MAC counts per neighbor: ACKs received and missed from it as the
+ * destination of our unicast frames, and frames received from it with their
+ * SNR. Next to the lifetime counts it keeps exponentially decayed ones, from
+ * which RPL and the objective function read the current on-link ETX and SNR.
+ */
+struct NeighborLink
+{
+    static constexpr double MAX_ETX = 100;    // ETX of a link none of whose recent frames were acknowledged
+
+    MacAddress address;
+    double ackReceived = 0;
+    double ackMissed = 0;   // the neighbor was sent ackReceived + ackMissed frames
+    double framesReceived = 0;
+
+    // the counts above with every sample weighted down by its age, see NeighborLinkTable::setHalfLife()
+    double recentAckReceived = 0;
+    double recentAckMissed = 0;
+    double recentFrames = 0;
+    double recentSnrSum = 0;
+    simtime_t lastAck;
+    simtime_t lastFrame;
+
+    /** @return recent ETX, 1 before any frame was sent to the neighbor, at most MAX_ETX */
+    double getEtx() const;
+
+    /** @return recent average SNR of the frames received from the neighbor, 0 before the first one */
+    double getSnr() const { return recentFrames > 0 ? recentSnrSum / recentFrames : 0; }
+};
+
+/**
+ * Per-neighbor link table of the 802.15.4 MAC. Entries are stored by value in
+ * a vector in order of first contact, which is the order of the former list of
+ * ParentStructure pointers, and indexed by node id (the MAC address as an
+ * integer) in a hash map. The receive path and the lookups from the upper
+ * layers find an entry in constant time, and the entries go away with the table.
+ *
+ * The recent counts decay with the half-life given to setHalfLife(): on every
+ * sample the previous ones are weighted down by the time since the last one,
+ * so updates and queries stay O(1) and a link that got worse (or better) shows
+ * within a half-life however long the simulation ran before.
+ *
+ * Pointers and references to entries stay valid until the next neighbor is added.
+ */
+class INET_API NeighborLinkTable
+{
+  public:
+    typedef std::vector<NeighborLink>::const_iterator const_iterator;
+
+  private:
+    std::vector<NeighborLink> links;
+    std::unordered_map<uint64_t, size_t> index;  // node id -> position in links
+    simtime_t halfLife;
+
+    /** @return weight of the samples before now relative to the one at @param last, which is moved to now */
+    double decay(simtime_t& last) const;
+
+  public:
+    const_iterator begin() const { return links.begin(); }
+    const_iterator end() const { return links.end(); }
+    size_t size() const { return links.size(); }
+
+    /** @return entry of the neighbor with @param nodeId, nullptr if we never heard from it nor sent to it */
+    const NeighborLink *find(uint64_t nodeId) const;
+    NeighborLink *find(uint64_t nodeId) { return const_cast<NeighborLink *>(static_cast<const NeighborLinkTable *>(this)->find(nodeId)); }
+
+    /** @return entry of the neighbor with @param address, added on first contact */
+    NeighborLink& get(const MacAddress& address);
+
+    /** Count an ACK from @param link as received if @param acked, else as missed */
+    void recordAck(NeighborLink& link, bool acked);
+
+    /** Count a frame received from @param link with @param snr */
+    void recordFrame(NeighborLink& link, double snr);
+
+    /** Samples lose half their weight every @param halfLife, 0 keeps the lifetime counts */
+    void setHalfLife(simtime_t halfLife) { this->halfLife = halfLife; }
+
+    void clear() { links.clear(); index.clear(); }
+};
+
+} // namespace inet
+
+#endif
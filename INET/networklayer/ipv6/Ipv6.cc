@@ -40,6 +40,9 @@
 #include "inet/networklayer/ipv6/Ipv6ExtensionHeaders_m.h"
 #include "inet/networklayer/ipv6/Ipv6ExtHeaderTag_m.h"
 #include "inet/networklayer/ipv6/Ipv6InterfaceData.h"
+#include "inet/routing/rpl/HostBindings.h"
+#include "inet/routing/rpl/FeatureExport.h"
+#include "inet/routing/rpl/PacketTrace.h"
 
 #ifdef WITH_xMIPv6
 #include "inet/networklayer/xmipv6/MobilityHeader_m.h"
@@ -127,6 +130,10 @@ void Ipv6::initialize(int stage)
         }
         // custom part end
 
+        // MAC and RPL of this host, bound once instead of looked up per forwarded packet
+        auto bindings = HostBindings::get(this);
+        mac = bindings->getMac();
+        rpl = bindings->getRpl();
 
         cModule *node = findContainingNode(this);
         NodeStatus *nodeStatus = node ? check_and_cast_nullable<NodeStatus *>(node->getSubmodule("status")) : nullptr;
@@ -467,22 +474,14 @@ void Ipv6::routePacket(Packet *packet, const InterfaceEntry *destIE, const Inter
         //end CL version
 
         //To register forwarded packets   2021-11-26
-        macModule = getParentModule()->getParentModule()->getSubmodule("wlan",0)->getSubmodule("mac");
-        mac = check_and_cast<Ieee802154Mac *>(macModule);
-
         //EV_INFO << "macModule: " << macModule << endl;
         //EV_INFO << "packet Size: " << packet->getByteLength() << endl;
         //uint64_t nodeId = mac->IPfromUpperLayers(packet);
         //EV_INFO << "node_id of destination based on IP address = " << nodeId << endl;
         //EV_INFO << "instantenous on link etx = " << ((mac->getACKmissed(nodeId) + mac->getACKrcv(nodeId))/mac->getACKrcv(nodeId)) << endl;
 
-        rplModule = getParentModule()->getParentModule()->getSubmodule("rpl");
-        //EV_INFO << rplModule << endl;
-        rpl = check_and_cast<Rpl *>(rplModule);
         //EV_INFO << rpl->getRank() << endl;
 
-        std:: ofstream file;
-        file.open("St_packet-tracer.txt", std::ios_base::app);
         //if (packetName != "DAOpacket"){  //modified on 2022-01-18 for the lines below
         //if (packetName == "dBilling" || packetName == "dAPQ" || packetName == "dAEV" ){
         if (packetName[0] == 'd'){
@@ -499,81 +498,47 @@ void Ipv6::routePacket(Packet *packet, const InterfaceEntry *destIE, const Inter
         else
             rpl->updateBestCandidate();
 */
-        double fail_retry = 0;
-        double fail_cong = 0;
-        double fail_retry_current_value;
-        double fail_cong_current_value;
-        double rx_frame_rate;
-        double current_rx_frame_rate = mac->nbRxFrames_copy;
-
-        if (simTime() - mac->last_reading > 300){
-            double beta = 0.9;
-            //dio->setRx_suc_rate(beta*(radio->rx_successful_rate) + (1-beta)*radio->rx_successful_rate_copy);
-            if (mac->nbTxFrames_copy + mac->txAttempts_copy == 0)
-                fail_retry_current_value = 0;
-            else
-                fail_retry_current_value = (mac->framedropbyretry_limit_reached + mac->txAttempts_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy);
-
-            fail_retry = beta*fail_retry_current_value + (1-beta)*mac->fail_rate_retry ;
-
-            if (mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy == 0)
-                fail_cong_current_value = 0;
-            else
-                fail_cong_current_value = (mac->framedropbycongestion + mac->txAttempts_copy + mac->NB_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy);
-
-            fail_cong = beta*fail_cong_current_value + (1-beta)*mac->fail_rate_cong ;
-
-            rx_frame_rate = beta*current_rx_frame_rate + (1-beta)*mac->rx_frames_rate ;  //check this!!!!!!!!
-
-            } else {
-            double beta = 0.6;
-            if (mac->nbTxFrames_copy + mac->txAttempts_copy == 0)
-                fail_retry_current_value = 0;
-            else
-                fail_retry_current_value = (mac->framedropbyretry_limit_reached + mac->txAttempts_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy);
-
-            fail_retry = beta*fail_retry_current_value + (1-beta)*mac->fail_rate_retry ;
-
-            if (mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy == 0)
-                fail_cong_current_value = 0;
-            else
-                fail_cong_current_value = (mac->framedropbycongestion + mac->txAttempts_copy + mac->NB_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy);
-
-            fail_cong = beta*fail_cong_current_value + (1-beta)*mac->fail_rate_cong ;
-
-            rx_frame_rate = beta*current_rx_frame_rate + (1-beta)*mac->rx_frames_rate ;  //check this!!!!!!!!
-        }
-
-        //To do the same with the ch utilization
-            double current_ch_util;
-            if ((mac->busy + mac->idle) == 0)
-                current_ch_util = 0;
-            else
-                current_ch_util =mac->busy/(mac->busy + mac->idle);
-
-            double my_ch_util = 0;
-
-            if (simTime() - mac->last_ch_uti_reset > 300){
-                double beta = 0.9;
-                my_ch_util = beta*current_ch_util + (1-beta)*mac->channel_util ;
-            } else {
-                double beta = 0.6;
-                my_ch_util = beta*current_ch_util + (1-beta)*mac->channel_util ;
+            //fail rates, rx frame rate and channel utilization as estimated by the MAC
+            const LinkMetrics& linkMetrics = mac->getLinkMetrics();
+            PacketTraceRecord record;
+            record.time = simTime();
+            record.node = getParentModule()->getParentModule()->getFullName();
+            record.event = "pkt_frwd";
+            record.packet = packetName.c_str();
+            record.hc = rpl->getHC();
+            record.etx = round(rpl->getETX()*100.0)/100.0;
+            record.dropB = rpl->getdropB();
+            record.dropR = rpl->getdropR();
+            record.txF = round(rpl->gettxF()*100.0)/100.0;
+            record.rxF = round(rpl->getrxF()*100.0)/100.0;
+            record.bw = round(rpl->getbw()*100.0)/100.0;
+            record.den = rpl->getden();
+            record.qu = round(rpl->getqu()*100.0)/100.0;
+            record.chUtil = round(linkMetrics.getChannelUtilization()*100.0)/100.0;
+            record.macQu = round(linkMetrics.getQueueUtilization()*100.0)/100.0;
+            record.failRetry = round(linkMetrics.getFailRateRetry()*100.0)/100.0;
+            record.failCong = round(linkMetrics.getFailRateCong()*100.0)/100.0;
+            record.neighbors = rpl->getneighbors();
+            record.etxInst = round(rpl->getetx_int()*100.0)/100.0;
+            record.fps = round(rpl->getfps()*100.0)/100.0;
+            record.lastUpdate = rpl->getlastupdate();
+            record.snr = rpl->getSNR();
+            record.snrInst = round(rpl->getsnr_inst()*100)/100.0;
+            record.rxRate = round(linkMetrics.getRxFrameRate()*100.0)/100.0;
+            PacketTrace::getInstance().record(record);
+
+            FeatureExport& featureExport = FeatureExport::getInstance();
+            if (featureExport.isEnabled()) {
+                FeatureRecord features;
+                features.time = simTime();
+                features.node = record.node;
+                features.packet = record.packet;
+                rpl->getLinkFeatures(features);
+                featureExport.recordHop(features);
             }
 
-            file << simTime() <<" " << getParentModule()->getParentModule()->getFullName() << " pkt_frwd " << packetName <<" " <<
-            rpl->getHC() << " " << round(rpl->getETX()*100.0)/100.0 << " " <<  rpl->getdropB() << " " <<
-            rpl->getdropR() << " " << round(rpl->gettxF()*100.0)/100.0 << " " << round(rpl->getrxF()*100.0)/100.0 << " " <<
-            round(rpl->getbw()*100.0)/100.0 << " " << rpl->getden() << " " << round(rpl->getqu()*100.0)/100.0 << " " <<
-            round(my_ch_util*100.0)/100.0 << " " << round(mac->qu*100.0)/100.0 << " " <<
-            round(fail_retry*100.0)/100.0 << " " << round(fail_cong*100.0)/100.0 << " " <<
-            rpl->getneighbors() << " " << round(rpl->getetx_int()*100.0)/100.0 << " " <<
-            round(rpl->getfps()*100.0)/100.0 << " " << rpl->getlastupdate()  << " " << rpl->getSNR() <<
-            " " << round(rpl->getsnr_inst()*100)/100.0 << " " << round(rx_frame_rate*100.0)/100.0 << endl ;
-
 
         }
-        file.close();
 
         //end CL code
 
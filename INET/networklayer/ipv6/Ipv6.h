@@ -110,11 +110,9 @@ class INET_API Ipv6 : public cSimpleModule, public NetfilterBase, public Lifecyc
     int numForwarded = 0;
 
     //To get variables from L2   CL 2021-11-09
-    cModule *macModule = nullptr;
     Ieee802154Mac *mac = nullptr;
 
     //To get variables from Rpl module   CL 2021-12-10
-    cModule *rplModule = nullptr;
     Rpl *rpl = nullptr;
 
 #ifdef WITH_xMIPv6
@@ -0,0 +1,103 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "inet/routing/rpl/ColumnBlockWriter.h"
+
+namespace inet {
+
+ColumnBlockWriter::ColumnBlockWriter(const std::vector<TraceColumn>& schema, uint32_t rowsPerBlock) :
+    schema(schema),
+    rowsPerBlock(rowsPerBlock),
+    columns(schema.size())
+{
+}
+
+void ColumnBlockWriter::open(const char *fileName)
+{
+    channel = TraceSink::getInstance().getChannel(fileName, true);
+
+    // schema
+    PacketTraceFileHeader fileHeader;
+    memset(&fileHeader, 0, sizeof(fileHeader));
+    memcpy(fileHeader.magic, PACKET_TRACE_MAGIC, sizeof(fileHeader.magic));
+    fileHeader.version = PACKET_TRACE_VERSION;
+    fileHeader.numColumns = schema.size();
+    fileHeader.simtimeScaleExp = SimTime::getScaleExp();
+    fileHeader.rowsPerBlock = rowsPerBlock;
+    std::string header((const char *)&fileHeader, sizeof(fileHeader));
+    for (const TraceColumn& column : schema) {
+        PacketTraceColumnHeader columnHeader;
+        memset(&columnHeader, 0, sizeof(columnHeader));
+        strncpy(columnHeader.name, column.name, sizeof(columnHeader.name) - 1);
+        columnHeader.type = column.type;
+        columnHeader.width = packetTraceColumnWidth(column.type);
+        header.append((const char *)&columnHeader, sizeof(columnHeader));
+    }
+    channel->setHeader(header);
+}
+
+void ColumnBlockWriter::putString(const char *value)
+{
+    // node and event names repeat on almost every row, store them once per block
+    auto it = heapIndex.find(value);
+    if (it == heapIndex.end()) {
+        it = heapIndex.emplace(value, (uint32_t)heap.size()).first;
+        heap.append(value, strlen(value) + 1);
+    }
+    put<uint32_t>(it->second);
+}
+
+void ColumnBlockWriter::endRow()
+{
+    ASSERT(nextColumn == schema.size());
+    nextColumn = 0;
+    if (++numRows == rowsPerBlock)
+        flushBlock();
+}
+
+void ColumnBlockWriter::flushBlock()
+{
+    if (numRows == 0)
+        return;
+
+    static const char padding[8] = {};
+    PacketTraceBlockHeader blockHeader;
+    blockHeader.magic = PACKET_TRACE_BLOCK_MAGIC;
+    blockHeader.numRows = numRows;
+    blockHeader.heapSize = heap.size();
+    blockHeader.reserved = 0;
+    channel->append((const char *)&blockHeader, sizeof(blockHeader));
+    for (auto& column : columns) {
+        channel->append(column.data(), column.size());
+        channel->append(padding, packetTraceAlign(column.size()) - column.size());
+        column.clear();
+    }
+    channel->append(heap.data(), heap.size());
+    channel->append(padding, packetTraceAlign(heap.size()) - heap.size());
+
+    heap.clear();
+    heapIndex.clear();
+    numRows = 0;
+}
+
+} // namespace inet
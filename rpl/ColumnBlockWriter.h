@@ -0,0 +1,79 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _COLUMNBLOCKWRITER_H
+#define _COLUMNBLOCKWRITER_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "inet/common/INETDefs.h"
+#include "inet/routing/rpl/PacketTraceFormat.h"
+#include "inet/routing/rpl/TraceSink.h"
+
+namespace inet {
+
+struct TraceColumn
+{
+    const char *name;
+    uint8_t type;
+};
+
+/**
+ * Writes rows of a fixed schema to a binary trace channel as column blocks
+ * (see PacketTraceFormat.h). Values are put column by column in schema order,
+ * endRow() completes the row and hands a full block over to the channel.
+ */
+class INET_API ColumnBlockWriter
+{
+  private:
+    std::vector<TraceColumn> schema;
+    uint32_t rowsPerBlock;
+    TraceChannel *channel = nullptr;
+
+    // block under construction
+    uint32_t numRows = 0;
+    size_t nextColumn = 0;
+    std::vector<std::string> columns;
+    std::string heap;
+    std::unordered_map<std::string, uint32_t> heapIndex;
+
+  public:
+    ColumnBlockWriter(const std::vector<TraceColumn>& schema, uint32_t rowsPerBlock);
+
+    /** Writes the rows to the binary trace file @param fileName, its schema goes first */
+    void open(const char *fileName);
+    bool isOpen() const { return channel != nullptr; }
+
+    template<typename T>
+    void put(T value) { columns[nextColumn++].append((const char *)&value, sizeof(value)); }
+    void putSimtime(simtime_t value) { put<int64_t>(value.raw()); }
+    void putString(const char *value);
+    void endRow();
+
+    /** Hands the rows so far over to the channel, blocks carry their own row count */
+    void flushBlock();
+};
+
+} // namespace inet
+
+#endif
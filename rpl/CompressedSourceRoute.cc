@@ -0,0 +1,120 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "inet/routing/rpl/CompressedSourceRoute.h"
+
+namespace inet {
+
+namespace {
+
+/** RFC 6554 allows to elide at most 15 octets */
+const int MAX_ELIDED_OCTETS = 15;
+
+void toOctets(const Ipv6Address& address, uint8_t *octets)
+{
+    const uint32_t *words = address.words();
+    for (int i = 0; i < 16; i++)
+        octets[i] = (uint8_t)(words[i / 4] >> (24 - 8 * (i % 4)));
+}
+
+Ipv6Address fromOctets(const uint8_t *octets)
+{
+    uint32_t words[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < 16; i++)
+        words[i / 4] |= (uint32_t)octets[i] << (24 - 8 * (i % 4));
+    return Ipv6Address(words[0], words[1], words[2], words[3]);
+}
+
+int commonOctets(const uint8_t *a, const uint8_t *b)
+{
+    int n = 0;
+    while (n < MAX_ELIDED_OCTETS && a[n] == b[n])
+        n++;
+    return n;
+}
+
+} // namespace
+
+void CompressedSourceRoute::setAddresses(const std::deque<Ipv6Address>& addresses, const Ipv6Address& destination)
+{
+    ASSERT(addresses.size() <= UINT16_MAX);
+    reference = destination;
+    numAddresses = addresses.size();
+    first = 0;
+
+    uint8_t referenceOctets[16], addressOctets[16];
+    toOctets(reference, referenceOctets);
+    cmprI = numAddresses > 1 ? MAX_ELIDED_OCTETS : 0;
+    for (int i = 0; i + 1 < numAddresses; i++) {
+        toOctets(addresses[i], addressOctets);
+        cmprI = std::min(cmprI, (uint8_t)commonOctets(addressOctets, referenceOctets));
+    }
+    cmprE = 0;
+    if (numAddresses > 0) {
+        toOctets(addresses.back(), addressOctets);
+        cmprE = commonOctets(addressOctets, referenceOctets);
+    }
+
+    size_t length = numAddresses > 0 ? (numAddresses - 1) * (16 - cmprI) + (16 - cmprE) : 0;
+    if (length > INLINE_CAPACITY)
+        heapOctets.resize(length);
+    else
+        heapOctets.clear();
+
+    uint8_t *out = octets();
+    for (int i = 0; i < numAddresses; i++) {
+        int elided = i + 1 < numAddresses ? cmprI : cmprE;
+        toOctets(addresses[i], addressOctets);
+        memcpy(out, addressOctets + elided, 16 - elided);
+        out += 16 - elided;
+    }
+}
+
+Ipv6Address CompressedSourceRoute::get(int i) const
+{
+    ASSERT(i >= 0 && i < size());
+    int index = first + i;
+    int elided = index + 1 < numAddresses ? cmprI : cmprE;
+    uint8_t addressOctets[16];
+    toOctets(reference, addressOctets);
+    memcpy(addressOctets + elided, octets() + index * (16 - cmprI), 16 - elided);
+    return fromOctets(addressOctets);
+}
+
+B CompressedSourceRoute::getLength() const
+{
+    int length = 8;
+    if (numAddresses > 0)
+        length += (numAddresses - 1) * (16 - cmprI) + (16 - cmprE);
+    return B((length + 7) / 8 * 8);
+}
+
+std::ostream& operator<<(std::ostream& os, const CompressedSourceRoute& route)
+{
+    for (int i = 0; i < route.size(); i++)
+        os << (i ? " => " : "") << route.get(i);
+    return os << " (CmprI " << route.getCmprI() << ", CmprE " << route.getCmprE() << ", " << route.getLength() << ")";
+}
+
+} // namespace inet
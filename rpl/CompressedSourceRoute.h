@@ -0,0 +1,90 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _COMPRESSEDSOURCEROUTE_H
+#define _COMPRESSEDSOURCEROUTE_H
+
+#include <deque>
+#include <vector>
+
+#include "inet/common/INETDefs.h"
+#include "inet/common/Units.h"
+#include "inet/networklayer/contract/ipv6/Ipv6Address.h"
+
+namespace inet {
+
+/**
+ * Hop list of a source routing header kept the way RFC 6554 puts it on the
+ * wire: the octets every address shares with a reference address (the final
+ * destination, carried in the IPv6 header) are elided, CmprI of them for the
+ * intermediate hops and CmprE for the last one. Only the remaining octets are
+ * stored, inline for up to 8 hops with 8-byte interface IDs.
+ *
+ * As in RFC 6554 forwarding does not shrink the header, popFront() only
+ * advances past the visited hop (Segments Left), so getLength() stays the same
+ * along the whole path.
+ */
+class INET_API CompressedSourceRoute
+{
+  private:
+    enum { INLINE_CAPACITY = 64 };
+
+    Ipv6Address reference;
+    uint8_t cmprI = 0;
+    uint8_t cmprE = 0;
+    uint16_t numAddresses = 0;
+    uint16_t first = 0;
+    uint8_t inlineOctets[INLINE_CAPACITY];
+    std::vector<uint8_t> heapOctets;
+
+    uint8_t *octets() { return heapOctets.empty() ? inlineOctets : heapOctets.data(); }
+    const uint8_t *octets() const { return heapOctets.empty() ? inlineOctets : heapOctets.data(); }
+
+  public:
+    /** Compress @param addresses against @param destination */
+    void setAddresses(const std::deque<Ipv6Address>& addresses, const Ipv6Address& destination);
+
+    /** Number of hops not visited yet */
+    int size() const { return numAddresses - first; }
+    bool empty() const { return size() == 0; }
+
+    /** @return @param i th hop not visited yet, 0 being the next one */
+    Ipv6Address get(int i) const;
+    Ipv6Address front() const { return get(0); }
+    Ipv6Address back() const { return get(size() - 1); }
+    void popFront() { ASSERT(!empty()); first++; }
+
+    int getCmprI() const { return cmprI; }
+    int getCmprE() const { return cmprE; }
+
+    /**
+     * Size of the routing header on the wire [RFC6554, 3]: 8 octets of fixed
+     * fields, (n - 1) * (16 - CmprI) + (16 - CmprE) octets of addresses,
+     * padded to a multiple of 8 octets
+     */
+    B getLength() const;
+};
+
+std::ostream& operator<<(std::ostream& os, const CompressedSourceRoute& route);
+
+} // namespace inet
+
+#endif
@@ -0,0 +1,125 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <sstream>
+
+#include "inet/routing/rpl/DaoAckTimerWheel.h"
+
+namespace inet {
+
+void DaoAckTimerWheel::arm(const Ipv6Address& dest, simtime_t timeout, simtime_t now)
+{
+    // an idle wheel does not tick, catch up with the clock first
+    if (numArmed == 0)
+        currentTick = now.raw() / resolution.raw();
+
+    // round up, so a DAO never times out earlier than asked for
+    int64_t tick = (timeout.raw() + resolution.raw() - 1) / resolution.raw();
+    if (tick <= currentTick)
+        tick = currentTick + 1;
+
+    Entry& entry = entries[dest];
+    if (entry.tick == tick)
+        return;
+    if (entry.tick == -1)
+        numArmed++;
+    entry.tick = tick;
+    slots[tick % slots.size()].push_back(dest);
+}
+
+bool DaoAckTimerWheel::erase(const Ipv6Address& dest)
+{
+    auto it = entries.find(dest);
+    if (it == entries.end())
+        return false;
+    if (it->second.tick != -1)
+        numArmed--;
+    entries.erase(it);
+    return true;
+}
+
+void DaoAckTimerWheel::clear()
+{
+    for (auto& slot : slots)
+        slot.clear();
+    entries.clear();
+    numArmed = 0;
+    currentTick = 0;
+}
+
+void DaoAckTimerWheel::advance(simtime_t now, std::vector<Ipv6Address>& expired)
+{
+    int64_t nowTick = now.raw() / resolution.raw();
+    for (; currentTick < nowTick && numArmed > 0; ) {
+        currentTick++;
+        auto& slot = slots[currentTick % slots.size()];
+        size_t kept = 0;
+        for (size_t i = 0; i < slot.size(); i++) {
+            auto it = entries.find(slot[i]);
+            if (it == entries.end() || it->second.tick < currentTick || it->second.tick % (int64_t)slots.size() != currentTick % (int64_t)slots.size())
+                continue;   // acknowledged, expired or re-armed meanwhile
+            if (it->second.tick == currentTick) {
+                expired.push_back(slot[i]);
+                it->second.tick = -1;
+                numArmed--;
+            }
+            else
+                slot[kept++] = slot[i];    // due in a later round of the wheel
+        }
+        slot.resize(kept);
+    }
+    if (numArmed == 0)
+        currentTick = std::max(currentTick, nowTick);
+}
+
+simtime_t DaoAckTimerWheel::getNextDeadline() const
+{
+    ASSERT(numArmed > 0);
+    int64_t next = INT64_MAX;
+    for (const auto& entry : entries)
+        if (entry.second.tick != -1 && entry.second.tick < next)
+            next = entry.second.tick;
+    return resolution * next;
+}
+
+size_t DaoAckTimerWheel::getMemoryUsage() const
+{
+    size_t bytes = slots.capacity() * sizeof(slots[0]) + unorderedMemoryUsage(entries);
+    for (const auto& slot : slots)
+        bytes += slot.capacity() * sizeof(Ipv6Address);
+    return bytes;
+}
+
+std::string DaoAckTimerWheel::str() const
+{
+    std::ostringstream out;
+    for (const auto& entry : entries) {
+        out << entry.first << " (" << (int)entry.second.retries << " attempts), ";
+        if (entry.second.tick == -1)
+            out << "timed out" << endl;
+        else
+            out << "timeout at " << resolution * entry.second.tick << endl;
+    }
+    return out.str();
+}
+
+} // namespace inet
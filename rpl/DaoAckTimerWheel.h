@@ -0,0 +1,105 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DAOACKTIMERWHEEL_H
+#define _DAOACKTIMERWHEEL_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "inet/common/INETDefs.h"
+#include "inet/routing/rpl/Rpl_m.h"
+
+namespace inet {
+
+/**
+ * DAOs waiting for a DAO_ACK, with their timeouts in a hashed timer wheel.
+ * Timeouts are rounded up to ticks of the given resolution and the owner
+ * services the whole wheel with one self-message via advance(), scheduled
+ * for getNextDeadline(), instead of scheduling and cancelling one event per
+ * pending DAO. Ticks without a due timeout cost no event.
+ *
+ * Cancelling only erases the entry, the stale slot reference is dropped
+ * when its tick comes around.
+ */
+class INET_API DaoAckTimerWheel
+{
+  private:
+    struct Entry
+    {
+        int64_t tick = -1;  // tick of the timeout, -1 while not armed
+        uint8_t retries = 0;
+    };
+
+    simtime_t resolution;
+    int64_t currentTick = 0;    // last tick advance() went through
+    int numArmed = 0;
+    std::vector<std::vector<Ipv6Address>> slots;
+    std::unordered_map<Ipv6Address, Entry, Ipv6AddressHash> entries;
+
+  public:
+    DaoAckTimerWheel(int numSlots = 256) : resolution(1), slots(numSlots) {}
+
+    void setResolution(simtime_t resolution) { ASSERT(resolution > 0); this->resolution = resolution; }
+
+    bool empty() const { return entries.empty(); }
+    size_t size() const { return entries.size(); }
+    bool contains(const Ipv6Address& dest) const { return entries.count(dest) > 0; }
+
+    /**
+     * (Re)arm the timeout of the DAO advertising @param dest to expire at
+     * @param timeout, a new entry starts with no retries
+     */
+    void arm(const Ipv6Address& dest, simtime_t timeout, simtime_t now);
+
+    /** @return retransmissions so far of the DAO advertising @param dest, after counting one more */
+    int addRetry(const Ipv6Address& dest) { return ++entries[dest].retries; }
+    void setRetries(const Ipv6Address& dest, int retries) { entries[dest].retries = retries; }
+
+    /** @return true if an entry for @param dest existed */
+    bool erase(const Ipv6Address& dest);
+
+    /** Drop all entries and rewind the wheel, e.g. when the protocol stops */
+    void clear();
+
+    /** @return true while a timeout is armed, i.e. the wheel needs to be serviced */
+    bool isArmed() const { return numArmed > 0; }
+
+    /** @return the earliest armed timeout, rounded to its tick; only while isArmed() */
+    simtime_t getNextDeadline() const;
+
+    /**
+     * Go through all ticks up to @param now and append the destinations whose
+     * timeout expired to @param expired. Their entries stay, unarmed, until
+     * they are re-armed by a retransmission or erased.
+     */
+    void advance(simtime_t now, std::vector<Ipv6Address>& expired);
+
+    /** @return approximate heap use in bytes */
+    size_t getMemoryUsage() const;
+
+    std::string str() const;
+};
+
+} // namespace inet
+
+#endif
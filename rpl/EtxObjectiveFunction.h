@@ -0,0 +1,47 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ETXOBJECTIVEFUNCTION_H
+#define _ETXOBJECTIVEFUNCTION_H
+
+#include "inet/routing/rpl/ObjectiveFunction.h"
+
+namespace inet {
+
+/**
+ * ETX objective function: candidates are ranked by their advertised rank plus
+ * the on-link ETX from the MAC ACK counters, which is also added to the rank.
+ */
+class INET_API EtxObjectiveFunction : public ObjectiveFunction
+{
+  public:
+    virtual Ocp getOcp() const override { return ETX; }
+    virtual int getRequiredMetrics() const override { return RPL_METRIC_HOP_COUNT | RPL_METRIC_ETX; }
+
+  protected:
+    virtual const RplNeighbor *selectPreferredParent(const NeighborTable& candidateParents, const RplNeighbor *currentPreferredParent) override;
+    virtual double getRankIncrease(const RplNeighbor *parent) override { return ETX_Calculator_onLink_calcRank(parent) + 1; }
+    virtual double getTempRankIncrease(const Ptr<const Dio>& dio) override { return ETX_Calculator_onLink(dio) + 1; }
+};
+
+} // namespace inet
+
+#endif
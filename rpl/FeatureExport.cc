@@ -0,0 +1,158 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "inet/routing/rpl/FeatureExport.h"
+
+namespace inet {
+
+Register_PerRunConfigOption(CFGID_FEATURE_EXPORT, "feature-export", CFG_BOOL, "false",
+        "Write the link features of every data packet hop, labelled with the packet's "
+        "delivery and latency, to St_features.bin for training the rank model.");
+Register_PerRunConfigOption_u(CFGID_FEATURE_EXPORT_OUTCOME_TIMEOUT, "feature-export-outcome-timeout", "s", "600s",
+        "Packets that have not reached the sink this long after being sent are exported as lost.");
+
+namespace {
+
+const std::vector<TraceColumn> featureColumns = {
+    { "time", PT_SIMTIME },
+    { "node", PT_STRING },
+    { "packet", PT_STRING },
+    { "parent", PT_INT64 },
+    { "hc", PT_INT32 },
+    { "bw", PT_DOUBLE },
+    { "den", PT_INT32 },
+    { "etxOnLink", PT_DOUBLE },
+    { "fps", PT_DOUBLE },
+    { "drop", PT_INT32 },
+    { "delivered", PT_INT32 },
+    { "latency", PT_SIMTIME },
+};
+
+} // namespace
+
+FeatureExport::FeatureExport() :
+    blocks(featureColumns, ROWS_PER_BLOCK)
+{
+    TraceSink::getInstance().addProducer(this);
+}
+
+FeatureExport::~FeatureExport()
+{
+    blocks.flushBlock();
+    TraceSink::getInstance().removeProducer(this);
+}
+
+FeatureExport& FeatureExport::getInstance()
+{
+    static FeatureExport instance;
+    return instance;
+}
+
+void FeatureExport::resolveState()
+{
+    cConfiguration *config = getEnvir()->getConfig();
+    if (!config->getAsBool(CFGID_FEATURE_EXPORT)) {
+        state = STATE_DISABLED;
+        return;
+    }
+    state = STATE_ENABLED;
+    outcomeTimeout = config->getAsDouble(CFGID_FEATURE_EXPORT_OUTCOME_TIMEOUT);
+    blocks.open("St_features.bin");
+}
+
+void FeatureExport::recordHop(const FeatureRecord& record)
+{
+    if (!isEnabled())
+        return;
+    expire(record.time - outcomeTimeout);
+
+    auto& hops = pending[record.packet];
+    if (hops.empty())
+        sendOrder.emplace_back(record.time, record.packet);
+    hops.push_back(PendingHop { record, record.node, record.packet });
+}
+
+void FeatureExport::recordDelivery(const char *packet)
+{
+    if (!isEnabled())
+        return;
+    auto it = pending.find(packet);
+    if (it == pending.end())
+        return;    // duplicate, or already exported as lost
+    simtime_t now = simTime();
+    for (const PendingHop& hop : it->second)
+        write(hop, true, now - hop.record.time);
+    pending.erase(it);
+}
+
+void FeatureExport::expire(simtime_t sentBefore)
+{
+    // a delivered packet leaves its entry in sendOrder behind, it's skipped here
+    while (!sendOrder.empty() && sendOrder.front().first < sentBefore) {
+        auto it = pending.find(sendOrder.front().second);
+        if (it != pending.end()) {
+            for (const PendingHop& hop : it->second)
+                write(hop, false, SIMTIME_ZERO);
+            pending.erase(it);
+        }
+        sendOrder.pop_front();
+    }
+}
+
+void FeatureExport::write(const PendingHop& hop, bool delivered, simtime_t latency)
+{
+    const FeatureRecord& r = hop.record;
+    blocks.putSimtime(r.time);
+    blocks.putString(hop.node.c_str());
+    blocks.putString(hop.packet.c_str());
+    blocks.put<int64_t>(r.parent);
+    blocks.put<int32_t>(r.hc);
+    blocks.put<double>(r.bw);
+    blocks.put<int32_t>(r.den);
+    blocks.put<double>(r.etxOnLink);
+    blocks.put<double>(r.fps);
+    blocks.put<int32_t>(r.drop);
+    blocks.put<int32_t>(delivered);
+    blocks.putSimtime(latency);
+    blocks.endRow();
+}
+
+void FeatureExport::flushTrace(bool endOfRun)
+{
+    if (state != STATE_ENABLED)
+        return;
+    if (endOfRun) {
+        // whatever is still in flight didn't make it
+        for (const auto& entry : sendOrder) {
+            auto it = pending.find(entry.second);
+            if (it != pending.end()) {
+                for (const PendingHop& hop : it->second)
+                    write(hop, false, SIMTIME_ZERO);
+                pending.erase(it);
+            }
+        }
+        sendOrder.clear();
+        state = STATE_UNRESOLVED;
+    }
+    blocks.flushBlock();
+}
+
+} // namespace inet
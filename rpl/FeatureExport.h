@@ -0,0 +1,111 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FEATUREEXPORT_H
+#define _FEATUREEXPORT_H
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "inet/common/INETDefs.h"
+#include "inet/routing/rpl/ColumnBlockWriter.h"
+#include "inet/routing/rpl/TraceSink.h"
+
+namespace inet {
+
+/**
+ * Link features of one hop of a data packet: the node sending or forwarding
+ * it and the preferred parent it goes to, with the model inputs of that link
+ * (see ObjectiveFunction::ML_FEATURE_COUNT).
+ */
+struct FeatureRecord
+{
+    simtime_t time;
+    const char *node = "";
+    const char *packet = "";
+    uint64_t parent = 0;    // node id of the preferred parent, 0 without one
+    int hc = 0;
+    double bw = 0;
+    int den = 0;
+    double etxOnLink = 0;
+    double fps = 0;
+    int drop = 0;
+};
+
+/**
+ * Training set export for the rank model, enabled with the feature-export
+ * configuration option. Every hop of a data packet is recorded with its link
+ * features and held back until the outcome of the packet is known, then
+ * written to St_features.bin as one row with the labels joined in:
+ * 'delivered' and 'latency', the time from this hop to the arrival at the
+ * sink. A packet that has not arrived after feature-export-outcome-timeout,
+ * or by the end of the run, is labelled as lost.
+ *
+ * The file uses the column block layout of the binary packet trace
+ * (PacketTraceFormat.h), so tools/PacketTraceConvert turns it into CSV.
+ */
+class INET_API FeatureExport : public ITraceProducer
+{
+  private:
+    struct PendingHop
+    {
+        FeatureRecord record;
+        std::string node;
+        std::string packet;
+    };
+
+    static const uint32_t ROWS_PER_BLOCK = 4096;
+
+    enum State { STATE_UNRESOLVED, STATE_DISABLED, STATE_ENABLED };
+    State state = STATE_UNRESOLVED;
+    simtime_t outcomeTimeout;
+    ColumnBlockWriter blocks;
+
+    // hops of the packets in flight, and the packets in order of their first hop
+    std::unordered_map<std::string, std::vector<PendingHop>> pending;
+    std::deque<std::pair<simtime_t, std::string>> sendOrder;
+
+    FeatureExport();
+    virtual ~FeatureExport();
+
+    void resolveState();
+    void expire(simtime_t sentBefore);
+    void write(const PendingHop& hop, bool delivered, simtime_t latency);
+
+  public:
+    static FeatureExport& getInstance();
+
+    bool isEnabled() { if (state == STATE_UNRESOLVED) resolveState(); return state == STATE_ENABLED; }
+
+    /** Records a hop of @param record.packet, sent or forwarded */
+    void recordHop(const FeatureRecord& record);
+
+    /** The sink received @param packet, labels its hops as delivered */
+    void recordDelivery(const char *packet);
+
+    virtual void flushTrace(bool endOfRun) override;
+};
+
+} // namespace inet
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "inet/routing/rpl/HcModObjectiveFunction.h"
+
+namespace inet {
+
+Define_Module(HcModObjectiveFunction);
+
+double HcModObjectiveFunction::Tie_breaker_Calculator(const RplNeighbor* candidate) {
+
+      double w1 = 0.51; //0.48; //0.76;
+      double w2 = 0.14; //0.12; //0.12;
+      double w3 = 0.14; //0.25; //0.07;
+      double w4 = 0.08; //0.09; //0.05;
+
+      double tie_breaker_score = w1*(Norm_etx(ETX_Calculator_onLink_calcRank(candidate))) + w2*(Norm_fps(candidate->getFps())) + w3*(Norm_maclosses(candidate->getDropB() + candidate->getDropR())) + w4*(candidate->getBw());
+
+      tie_breaker_score = round(tie_breaker_score*100)/100.0;  //2022-05-04
+
+      return tie_breaker_score;
+}
+
+const RplNeighbor *HcModObjectiveFunction::selectPreferredParent(const NeighborTable& candidateParents, const RplNeighbor *currentPreferredParent)
+{
+    // only neighbors sharing the lowest rank can win, the tie-breaker is computed just for them
+    double current_tie_breaker_score;
+    const RplNeighbor *newPrefParent = getLowestRankLowestScore(candidateParents, [this](const RplNeighbor *candidate) {
+        return Tie_breaker_Calculator(candidate);
+    }, current_tie_breaker_score, true);
+    EV_INFO <<"current_tie_breaker_score = " << current_tie_breaker_score << endl;
+
+    double currentPrefParent_tie_breaker_score = Tie_breaker_Calculator(currentPreferredParent);
+    if (newPrefParent->getRank() == currentPreferredParent->getRank() && current_tie_breaker_score == currentPrefParent_tie_breaker_score) {
+        EV_INFO << "Preferred parent did not change b/c the new one has the same ranking and tie-breaker score"  << endl ;
+        return currentPreferredParent;
+    }
+    return newPrefParent;
+}
+
+} // namespace inet
@@ -0,0 +1,56 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "inet/routing/rpl/HostBindings.h"
+
+#include "inet/common/ModuleAccess.h"
+#include "inet/linklayer/ieee802154/Ieee802154Mac.h"
+#include "inet/physicallayer/common/packetlevel/Radio.h"
+#include "inet/routing/rpl/ObjectiveFunction.h"
+#include "inet/routing/rpl/Rpl.h"
+
+namespace inet {
+
+Define_Module(HostBindings);
+
+void HostBindings::initialize(int stage)
+{
+    // after the physical layer is up and before the link layer, the earliest
+    // consumer, picks the pointers up
+    if (stage == INITSTAGE_NETWORK_INTERFACE_CONFIGURATION) {
+        mac = getModuleFromPar<Ieee802154Mac>(par("macModule"), this);
+        radio = getModuleFromPar<physicallayer::Radio>(par("radioModule"), this);
+        rpl = getModuleFromPar<Rpl>(par("rplModule"), this);
+        objectiveFunction = getModuleFromPar<ObjectiveFunction>(par("objectiveFunctionModule"), this);
+        EV_DETAIL << "Bound " << mac->getFullPath() << ", " << radio->getFullPath() << ", "
+                  << rpl->getFullPath() << ", " << objectiveFunction->getFullPath() << endl;
+    }
+}
+
+HostBindings *HostBindings::get(const cModule *module)
+{
+    cModule *bindings = getContainingNode(module)->getSubmodule("bindings");
+    if (bindings == nullptr)
+        throw cRuntimeError("Host of '%s' has no 'bindings' submodule", module->getFullPath().c_str());
+    return check_and_cast<HostBindings *>(bindings);
+}
+
+} // namespace inet
@@ -0,0 +1,69 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOSTBINDINGS_H
+#define _HOSTBINDINGS_H
+
+#include "inet/common/INETDefs.h"
+
+namespace inet {
+
+class Ieee802154Mac;
+class ObjectiveFunction;
+class Rpl;
+
+namespace physicallayer {
+class Radio;
+}
+
+/**
+ * Per-host cache of the cross-layer module pointers (MAC, radio, RPL and
+ * objective function). The modules are looked up by path and type-checked
+ * once, in INITSTAGE_NETWORK_INTERFACE_CONFIGURATION, so the layers keep plain
+ * pointers instead of walking the module tree and downcasting on every
+ * packet. Consumers pick them up in any later init stage.
+ */
+class INET_API HostBindings : public cSimpleModule
+{
+  private:
+    Ieee802154Mac *mac = nullptr;
+    physicallayer::Radio *radio = nullptr;
+    Rpl *rpl = nullptr;
+    ObjectiveFunction *objectiveFunction = nullptr;
+
+  protected:
+    virtual int numInitStages() const override { return NUM_INIT_STAGES; }
+    virtual void initialize(int stage) override;
+    virtual void handleMessage(cMessage *msg) override { throw cRuntimeError("This module doesn't handle messages"); }
+
+  public:
+    /** @return the bindings of the host containing @param module */
+    static HostBindings *get(const cModule *module);
+
+    Ieee802154Mac *getMac() const { ASSERT(mac); return mac; }
+    physicallayer::Radio *getRadio() const { ASSERT(radio); return radio; }
+    Rpl *getRpl() const { ASSERT(rpl); return rpl; }
+    ObjectiveFunction *getObjectiveFunction() const { ASSERT(objectiveFunction); return objectiveFunction; }
+};
+
+} // namespace inet
+
+#endif
@@ -0,0 +1,258 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "inet/routing/rpl/InferenceClient.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0    // macOS, SO_NOSIGPIPE is set on the socket instead
+#endif
+
+namespace inet {
+
+constexpr std::chrono::seconds InferenceClient::RETRY_INTERVAL;
+
+InferenceClient::InferenceClient(const std::string& address, std::chrono::milliseconds timeout) :
+    address(address),
+    timeout(timeout)
+{
+}
+
+InferenceClient::~InferenceClient()
+{
+    disconnect();
+}
+
+namespace {
+
+int openSocket(int family)
+{
+    int fd = socket(family, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+    return fd;
+}
+
+/** Non-blocking connect of @param fd, waiting at most @param timeoutMs for it to complete */
+bool connectWithin(int fd, const sockaddr *addr, socklen_t addrLen, int timeoutMs)
+{
+    if (connect(fd, addr, addrLen) == 0)
+        return true;
+    if (errno != EINPROGRESS)
+        return false;
+    pollfd pfd = { fd, POLLOUT, 0 };
+    if (poll(&pfd, 1, timeoutMs) != 1)
+        return false;
+    int error = 0;
+    socklen_t len = sizeof(error);
+    return getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0;
+}
+
+int remainingMs(std::chrono::steady_clock::time_point deadline)
+{
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+    return left > 0 ? (int)left : 0;
+}
+
+} // namespace
+
+bool InferenceClient::connectToServer()
+{
+    if (Clock::now() < nextConnectAttempt)
+        return false;
+
+    if (address.compare(0, 5, "unix:") == 0) {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        std::string path = address.substr(5);
+        if (path.size() >= sizeof(addr.sun_path))
+            throw cRuntimeError("Inference server socket path '%s' is too long", path.c_str());
+        strcpy(addr.sun_path, path.c_str());
+        fd = openSocket(AF_UNIX);
+        if (fd >= 0 && !connectWithin(fd, (const sockaddr *)&addr, sizeof(addr), timeout.count()))
+            disconnect();
+    }
+    else {
+        size_t colon = address.rfind(':');
+        if (colon == std::string::npos)
+            throw cRuntimeError("Inference server address '%s' is neither unix:<path> nor <host>:<port>", address.c_str());
+        std::string host = address.substr(0, colon);
+        std::string port = address.substr(colon + 1);
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo *results = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &results) == 0) {
+            for (addrinfo *ai = results; ai != nullptr && fd < 0; ai = ai->ai_next) {
+                fd = openSocket(ai->ai_family);
+                if (fd >= 0 && !connectWithin(fd, ai->ai_addr, ai->ai_addrlen, timeout.count()))
+                    disconnect();
+            }
+            freeaddrinfo(results);
+        }
+        if (fd >= 0) {
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        }
+    }
+    if (fd < 0)
+        nextConnectAttempt = Clock::now() + RETRY_INTERVAL;
+    return fd >= 0;
+}
+
+void InferenceClient::disconnect()
+{
+    if (fd >= 0)
+        close(fd);
+    fd = -1;
+    received.clear();
+}
+
+int InferenceClient::takeReplies(int numReplies, double *replies)
+{
+    int numTaken = 0;
+    size_t start = 0, end;
+    while (numTaken < numReplies && (end = received.find('\n', start)) != std::string::npos) {
+        char *parsed;
+        replies[numTaken] = strtod(received.c_str() + start, &parsed);
+        if (parsed == received.c_str() + start)
+            return -1;
+        numTaken++;
+        start = end + 1;
+    }
+    received.erase(0, start);
+    return numTaken;
+}
+
+bool InferenceClient::exchange(const std::string& request, int numReplies, double *replies, Clock::time_point deadline)
+{
+    // keep reading while writing, so a server that answers early can't block on a full socket buffer
+    size_t written = 0;
+    int numReceived = 0;
+    while (numReceived < numReplies) {
+        pollfd pfd = { fd, POLLIN, 0 };
+        if (written < request.size())
+            pfd.events |= POLLOUT;
+        int ready = poll(&pfd, 1, remainingMs(deadline));
+        if (ready < 0 && errno == EINTR)
+            continue;
+        if (ready != 1)
+            return false;
+        if (pfd.revents & POLLOUT) {
+            ssize_t n = send(fd, request.data() + written, request.size() - written, MSG_NOSIGNAL);
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                return false;
+            if (n > 0)
+                written += n;
+        }
+        if (pfd.revents & (POLLIN | POLLHUP | POLLERR)) {
+            char buffer[4096];
+            ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+                continue;
+            if (n < 0)
+                return false;
+            if (n == 0) {
+                // a server that closes after answering may leave out the last newline
+                if (!received.empty())
+                    received += '\n';
+            }
+            else
+                received.append(buffer, n);
+            int numTaken = takeReplies(numReplies - numReceived, replies + numReceived);
+            if (numTaken < 0)
+                return false;
+            numReceived += numTaken;
+            if (n == 0) {
+                disconnect();
+                return numReceived == numReplies;
+            }
+        }
+    }
+    return true;
+}
+
+bool InferenceClient::predict(const double *rows, int numRows, int featureCount, double *predictions)
+{
+    if (numRows == 0)
+        return true;
+    requests += numRows;
+    bool reused = fd >= 0;
+    if (!reused && !connectToServer()) {
+        failures += numRows;
+        return false;
+    }
+
+    std::string request;
+    char value[32];
+    for (int row = 0; row < numRows; row++) {
+        for (int feature = 0; feature < featureCount; feature++) {
+            snprintf(value, sizeof(value), feature == 0 ? "%.2f" : " %.2f", rows[row * featureCount + feature]);
+            request += value;
+        }
+        request += '\n';
+    }
+
+    Clock::time_point deadline = Clock::now() + timeout;
+    bool answered = exchange(request, numRows, predictions, deadline);
+    if (!answered && reused) {
+        // the server may have closed the idle connection, retry once on a new one
+        disconnect();
+        answered = connectToServer() && exchange(request, numRows, predictions, deadline);
+    }
+    if (!answered) {
+        // the connection may be out of sync with late replies, start over on a new one
+        disconnect();
+        nextConnectAttempt = Clock::now() + RETRY_INTERVAL;
+        failures += numRows;
+        return false;
+    }
+    return true;
+}
+
+InferenceClient& InferenceClient::getShared(const std::string& address, std::chrono::milliseconds timeout)
+{
+    static std::map<std::string, std::unique_ptr<InferenceClient>> clients;
+    auto& client = clients[address];
+    if (!client)
+        client.reset(new InferenceClient(address, timeout));
+    return *client;
+}
+
+} // namespace inet
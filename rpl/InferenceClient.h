@@ -0,0 +1,103 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INFERENCECLIENT_H
+#define _INFERENCECLIENT_H
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "inet/common/INETDefs.h"
+
+namespace inet {
+
+/**
+ * Client of the external ML inference server, over one persistent POSIX
+ * stream socket. The server address is either "unix:<path>" for a
+ * Unix-domain socket or "<host>:<port>" for TCP.
+ *
+ * Protocol: one request per line, the features separated by spaces with two
+ * decimals; the server answers every line with one line holding the
+ * predicted probability, in request order. A batch is written in one go and
+ * its answers are read as they come (pipelining), so scoring all candidates
+ * costs one round trip.
+ *
+ * predict() is synchronous: the OF needs the link costs of the DIO it is
+ * handling, so the event loop waits for each batch, up to the timeout.
+ * Requests are not kept in flight across calls; a reply arriving on a later
+ * event would make the simulation depend on the server's wall-clock latency
+ * and no longer reproducible. The prediction cache and the batching keep the
+ * number of round trips down instead.
+ *
+ * Every batch must be answered within the timeout. If the server is down or
+ * slow the connection is dropped and predict() fails right away; the next
+ * connection attempt is made only after RETRY_INTERVAL of wall-clock time
+ * (not simulation time, it protects the run from waiting on a dead server),
+ * so the simulation keeps running instead of waiting for the server.
+ */
+class INET_API InferenceClient
+{
+  public:
+    static constexpr std::chrono::seconds RETRY_INTERVAL { 1 };
+
+  private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::string address;
+    std::chrono::milliseconds timeout;
+    int fd = -1;
+    std::string received;    // bytes read but not yet consumed as replies
+    Clock::time_point nextConnectAttempt;
+    long requests = 0;
+    long failures = 0;
+
+    bool connectToServer();
+    void disconnect();
+    bool exchange(const std::string& request, int numReplies, double *replies, Clock::time_point deadline);
+    int takeReplies(int numReplies, double *replies);
+
+  public:
+    InferenceClient(const std::string& address, std::chrono::milliseconds timeout);
+    ~InferenceClient();
+    InferenceClient(const InferenceClient&) = delete;
+    InferenceClient& operator=(const InferenceClient&) = delete;
+
+    /**
+     * Score @param numRows rows of @param featureCount features each, stored
+     * row after row in @param rows, into @param predictions
+     * @return false if the server couldn't be reached or didn't answer all rows in time
+     */
+    bool predict(const double *rows, int numRows, int featureCount, double *predictions);
+
+    const std::string& getAddress() const { return address; }
+    bool isConnected() const { return fd >= 0; }
+    long getRequests() const { return requests; }
+    long getFailures() const { return failures; }
+
+    /** @return the client shared by all nodes for @param address, its timeout is taken from the first call */
+    static InferenceClient& getShared(const std::string& address, std::chrono::milliseconds timeout);
+};
+
+} // namespace inet
+
+#endif
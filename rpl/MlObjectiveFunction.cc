@@ -0,0 +1,44 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "inet/routing/rpl/MlObjectiveFunction.h"
+
+namespace inet {
+
+Define_Module(MlObjectiveFunction);
+
+const RplNeighbor *MlObjectiveFunction::selectPreferredParent(const NeighborTable& candidateParents, const RplNeighbor *currentPreferredParent)
+{
+    // score all candidates with one model evaluation
+    std::vector<const RplNeighbor *> candidates = getScanOrder(candidateParents);
+    std::vector<double> ranks = ML_rank_calculator_batch(candidates);
+    for (size_t i = 0; i < candidates.size(); i++)
+        ranks[i] += candidates[i]->getRank();
+    double currentMinRank;
+    const RplNeighbor *newPrefParent = getLowestScore(candidates, ranks, currentMinRank);
+    if (currentMinRank == currentPreferredParent->getRank()) {
+        EV_INFO << "Preferred parent did not change b/c the new one has the same ranking"  << endl ;
+        return currentPreferredParent;
+    }
+    return newPrefParent;
+}
+
+} // namespace inet
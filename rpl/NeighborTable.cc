@@ -0,0 +1,135 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "inet/routing/rpl/NeighborTable.h"
+
+namespace inet {
+
+void RplNeighbor::update(const Dio& dio, const DioRxInfo& rxInfo, int metrics)
+{
+    srcAddress = dio.getSrcAddress();
+    dodagId = dio.getDodagId();
+    nodeId = dio.getNodeId();
+    position = dio.getPosition();
+    color = dio.getColor();
+
+    rank = dio.getRank();
+    HC = dio.getHC();
+    last_update = dio.getLast_update();
+    rxTime = rxInfo.rxTime;
+    if (metrics & RPL_METRIC_ETX)
+        ETX = dio.getETX();
+    if (metrics & RPL_METRIC_LINK_QUALITY) {
+        dropB = dio.getDropB();
+        dropR = dio.getDropR();
+        missACK = dio.getMissACK();
+        txF = dio.getTxF();
+        rxF = dio.getRxF();
+        bw = dio.getBw();
+        den = dio.getDen();
+        qu = dio.getQu();
+        fps = dio.getFps();
+    }
+    if (metrics & RPL_METRIC_RADIO) {
+        snr = rxInfo.snr;
+        rx_un_suc = dio.getRx_un_suc();
+        rx_suc_rate = dio.getRx_suc_rate();
+    }
+    if (metrics & RPL_METRIC_PATH_COST)
+        path_cost = dio.getPath_cost();
+}
+
+namespace {
+
+bool addressLess(const RplNeighbor& neighbor, const Ipv6Address& address)
+{
+    return neighbor.getSrcAddress() < address;
+}
+
+} // namespace
+
+std::vector<RplNeighbor>::iterator NeighborTable::lowerBound(const Ipv6Address& address)
+{
+    return std::lower_bound(neighbors.begin(), neighbors.end(), address, addressLess);
+}
+
+const RplNeighbor *NeighborTable::find(const Ipv6Address& address) const
+{
+    auto it = std::lower_bound(neighbors.begin(), neighbors.end(), address, addressLess);
+    return it != neighbors.end() && it->getSrcAddress() == address ? &*it : nullptr;
+}
+
+NeighborTable::rank_iterator NeighborTable::lowestRankEnd() const
+{
+    if (rankIndex.empty())
+        return rankIndex.end();
+    double lowestRank = rankIndex.front().rank;
+    return std::upper_bound(rankIndex.begin(), rankIndex.end(), lowestRank,
+            [] (double rank, const RankKey& key) { return rank < key.rank; });
+}
+
+void NeighborTable::insertRank(double rank, const Ipv6Address& address)
+{
+    RankKey key = { rank, address };
+    rankIndex.insert(std::lower_bound(rankIndex.begin(), rankIndex.end(), key), key);
+}
+
+void NeighborTable::eraseRank(double rank, const Ipv6Address& address)
+{
+    RankKey key = { rank, address };
+    auto it = std::lower_bound(rankIndex.begin(), rankIndex.end(), key);
+    ASSERT(it != rankIndex.end() && it->address == address);
+    rankIndex.erase(it);
+}
+
+const RplNeighbor& NeighborTable::update(const Dio& dio, const DioRxInfo& rxInfo)
+{
+    auto it = lowerBound(dio.getSrcAddress());
+    if (it == neighbors.end() || it->getSrcAddress() != dio.getSrcAddress()) {
+        it = neighbors.insert(it, RplNeighbor());
+        it->update(dio, rxInfo, metrics);
+        insertRank(it->getRank(), it->getSrcAddress());
+    }
+    else {
+        double oldRank = it->getRank();
+        it->update(dio, rxInfo, metrics);
+        // most DIOs repeat the rank, the index stays as it is then
+        if (it->getRank() != oldRank) {
+            eraseRank(oldRank, it->getSrcAddress());
+            insertRank(it->getRank(), it->getSrcAddress());
+        }
+    }
+    return *it;
+}
+
+bool NeighborTable::erase(const Ipv6Address& address)
+{
+    auto it = lowerBound(address);
+    if (it == neighbors.end() || it->getSrcAddress() != address)
+        return false;
+    eraseRank(it->getRank(), address);
+    neighbors.erase(it);
+    return true;
+}
+
+} // namespace inet
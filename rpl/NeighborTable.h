@@ -0,0 +1,189 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _NEIGHBORTABLE_H
+#define _NEIGHBORTABLE_H
+
+#include <vector>
+
+#include "inet/common/INETDefs.h"
+#include "inet/routing/rpl/Rpl_m.h"
+#include "inet/routing/rpl/RplDefs.h"
+
+namespace inet {
+
+/**
+ * Receive-side annotations of a DIO. They travel next to the received chunk,
+ * which stays immutable, instead of being patched into a copy of it.
+ */
+struct DioRxInfo
+{
+    double snr = 0;     // average SNR of the link to the sender, from the MAC
+    simtime_t rxTime;
+};
+
+/**
+ * What RPL remembers about a neighbor from its latest DIO. Only the fields read
+ * by the objective function and by Rpl::updateMetrics_fromPrefParent() are kept,
+ * the getters have the same names as in the Dio message class.
+ */
+class INET_API RplNeighbor
+{
+  private:
+    Ipv6Address srcAddress;
+    Ipv6Address dodagId;
+    uint64_t nodeId = 0;
+    Coord position;
+    cFigure::Color color;
+
+    double rank = 0;
+    int HC = 0;
+    double ETX = 0;
+    int dropB = 0;
+    int dropR = 0;
+    int missACK = 0;
+    double txF = 0;
+    double rxF = 0;
+    double bw = 0;
+    int den = 0;
+    double qu = 0;
+    double fps = 0;
+    double snr = 0;
+    int rx_un_suc = 0;
+    double rx_suc_rate = 0;
+    double path_cost = 0;
+    simtime_t last_update;
+    simtime_t rxTime;
+
+  public:
+    RplNeighbor() {}
+    RplNeighbor(const Dio& dio, const DioRxInfo& rxInfo, int metrics) { update(dio, rxInfo, metrics); }
+
+    /**
+     * Overwrite the fields with the ones advertised in @param dio, except
+     * the SNR, which is our own measurement from @param rxInfo. Metric fields
+     * outside the RplMetric groups in @param metrics keep their defaults.
+     */
+    void update(const Dio& dio, const DioRxInfo& rxInfo, int metrics);
+
+    const Ipv6Address& getSrcAddress() const { return srcAddress; }
+    const Ipv6Address& getDodagId() const { return dodagId; }
+    uint64_t getNodeId() const { return nodeId; }
+    const Coord& getPosition() const { return position; }
+    const cFigure::Color& getColor() const { return color; }
+
+    double getRank() const { return rank; }
+    int getHC() const { return HC; }
+    double getETX() const { return ETX; }
+    int getDropB() const { return dropB; }
+    int getDropR() const { return dropR; }
+    int getMissACK() const { return missACK; }
+    double getTxF() const { return txF; }
+    double getRxF() const { return rxF; }
+    double getBw() const { return bw; }
+    int getDen() const { return den; }
+    double getQu() const { return qu; }
+    double getFps() const { return fps; }
+    double getSnr() const { return snr; }
+    int getRx_un_suc() const { return rx_un_suc; }
+    double getRx_suc_rate() const { return rx_suc_rate; }
+    double getPath_cost() const { return path_cost; }
+    simtime_t getLast_update() const { return last_update; }
+    simtime_t getRxTime() const { return rxTime; }
+};
+
+/**
+ * Candidate (or backup) parent set. Entries are stored by value in a vector
+ * sorted by address, so iteration order is the same as with the former
+ * std::map<Ipv6Address, Dio *>, and a DIO from a known neighbor just
+ * overwrites its entry in place instead of allocating a new copy.
+ *
+ * Next to it the table keeps a rank index, (rank, address) pairs in ascending
+ * order. Every objective function picks the parent with the lowest advertised
+ * rank first, so the index is only touched when a neighbor's rank changes and
+ * the lowest-rank group can be read off its front without scanning the table.
+ */
+class INET_API NeighborTable
+{
+  public:
+    struct RankKey
+    {
+        double rank;
+        Ipv6Address address;
+
+        bool operator<(const RankKey& other) const {
+            return rank < other.rank || (rank == other.rank && address < other.address);
+        }
+    };
+
+    typedef std::vector<RplNeighbor>::const_iterator const_iterator;
+    typedef std::vector<RankKey>::const_iterator rank_iterator;
+
+  private:
+    std::vector<RplNeighbor> neighbors;
+    std::vector<RankKey> rankIndex;
+    int metrics = RPL_METRICS_ALL;  // RplMetric groups kept per neighbor
+
+    std::vector<RplNeighbor>::iterator lowerBound(const Ipv6Address& address);
+    void insertRank(double rank, const Ipv6Address& address);
+    void eraseRank(double rank, const Ipv6Address& address);
+
+  public:
+
+    const_iterator begin() const { return neighbors.begin(); }
+    const_iterator end() const { return neighbors.end(); }
+    bool empty() const { return neighbors.empty(); }
+    size_t size() const { return neighbors.size(); }
+
+    /** @return entry of the neighbor with @param address, nullptr if unknown */
+    const RplNeighbor *find(const Ipv6Address& address) const;
+    bool contains(const Ipv6Address& address) const { return find(address) != nullptr; }
+
+    /**
+     * @return neighbor with the lowest advertised rank, the one with the lowest
+     * address among equal ranks (which is what a scan in address order would
+     * pick), nullptr if the table is empty
+     */
+    const RplNeighbor *getLowestRank() const { return rankIndex.empty() ? nullptr : find(rankIndex.front().address); }
+
+    /** Range of the rank index holding all neighbors that share the lowest rank */
+    rank_iterator lowestRankBegin() const { return rankIndex.begin(); }
+    rank_iterator lowestRankEnd() const;
+
+    /** Keep only the RplMetric groups in @param metrics from now on */
+    void setMetrics(int metrics) { this->metrics = metrics; }
+
+    /** Insert the sender of @param dio or refresh its entry */
+    const RplNeighbor& update(const Dio& dio, const DioRxInfo& rxInfo);
+
+    /** @return true if an entry for @param address existed */
+    bool erase(const Ipv6Address& address);
+    void clear() { neighbors.clear(); rankIndex.clear(); }
+
+    /** @return approximate heap use in bytes */
+    size_t getMemoryUsage() const {
+        return neighbors.capacity() * sizeof(RplNeighbor) + rankIndex.capacity() * sizeof(RankKey);
+    }
+};
+
+} // namespace inet
+
+#endif
@@ -23,11 +23,15 @@
 #define _OBJECTIVEFUNCTION_H
 
 #include <map>
+#include <memory>
+#include <unordered_map>
 #include <vector>
 
 #include "inet/common/INETDefs.h"
 #include "Rpl_m.h"
 #include "RplDefs.h"
+#include "inet/routing/rpl/NeighborTable.h"
+#include "inet/routing/rpl/PredictionCache.h"
 //#include "Rpl.h"
 #include "inet/linklayer/ieee802154/Ieee802154Mac.h"  //CL  2022-01-26: to access L2 layer
 
@@ -40,18 +44,28 @@
 #include <iomanip>
 //#include <Python.h>
 #include <stdio.h>
-#include <winsock.h>
 
 namespace inet {
 
+class InferenceClient;
+class ObliviousForest;
+
 //class Rpl;  // 2022-04-28: to avoid circular dependency between Rpl.h and ObjectiveFunction.h
 //class ObjectiveFunction ;  // 2022-05-03: to avoid circular dependency between Rpl.h and ObjectiveFunction.h
 
+/**
+ * Base of the objective function plugins, one subclass per OCP. The host's
+ * 'objectiveFunction' submodule picks the plugin by its NED type (see
+ * IObjectiveFunction), Rpl only talks to this interface.
+ *
+ * Next to rank and parent selection a plugin declares the RplMetric groups it
+ * reads, Rpl neither computes the others for its DIOs nor keeps them per
+ * neighbor. The shared candidate loops live here and take the plugin's score.
+ */
 //class ObjectiveFunction : public cObject   //Changed by CL 2022-01-27
 class ObjectiveFunction : public cSimpleModule
 {
-  private:
-    Ocp type; /** Objective Function (OF) type as defined in RFC 6551. */
+  protected:
     int minHopRankIncrease; /** base step of rank increment [RFC 6550, 6.7.6] */
 
     /*************CL*******************/
@@ -64,15 +78,20 @@ class ObjectiveFunction : public cSimpleModule
 
     //To get variables from L2   CL 2022-01-26
     cModule *host;
-    cModule *macModule = nullptr;
-    Ieee802154Mac *mac = nullptr;
+    Ieee802154Mac *mac = nullptr;    // bound from the host's HostBindings
 
     //To get variables from Rpl module   CL 2021-12-10
     cModule *rplModule = nullptr;
 //    Rpl *rpl = nullptr; //CL to access to Rpl.cc   22-05-03
 
     //In order to implement EWMA (Exponentially Weighted Moving Average) to calculate ETX
-    double etx_prev = 1;
+    // one average per neighbor, by node id, so scoring one neighbor doesn't change another's ETX
+    struct OnLinkEtx
+    {
+        double samples = 0;     // ACK samples of the link the average has seen
+        double etx = 1;
+    };
+    std::unordered_map<uint64_t, OnLinkEtx> onLinkEtx;
     double alpha = 0.8; //0.8 ; //0.8;
 
     double thre = 0 ;
@@ -82,48 +101,57 @@ class ObjectiveFunction : public cSimpleModule
 
   public:
     ObjectiveFunction();
-    ObjectiveFunction(std::string type);
 
    ~ObjectiveFunction();
 
+    /** @return Objective Code Point advertised in the DIOs [RFC 6551] */
+    virtual Ocp getOcp() const = 0;
+
+    /** @return RplMetric groups the scoring reads, OR-ed together */
+    virtual int getRequiredMetrics() const = 0;
+
+    /** @return true if a DIO that leaves the node's rank unchanged may still change its preferred parent */
+    virtual bool reevaluatesOnEqualRank() const { return false; }
+
     /**
      * Determine node's preferred parent from the candidate neighbor set using
      * relevant metric (defined by OF type).
      *
-     * @param candidateParents map of node's neighborhood in form of latest DIO packets
+     * @param candidateParents node's neighborhood, as advertised in the latest DIO
      * from each neighbor
      * @return best parent candidate based on the type of objective function in use
      */
+    const RplNeighbor* getPreferredParent(const NeighborTable& candidateParents, const RplNeighbor* currentPreferredParent);
 
-    virtual Dio* getPreferredParent(std::map<Ipv6Address, Dio *> candidateParents, Dio* currentPreferredParent); //back to
-                                                                    //this method on 2022-04-29
-    //virtual Dio* getPreferredParent(std::map<Ipv6Address, Dio *> candidateParents);  //2022-03-08
+    /** @return best forwarding candidate, the lowest-rank neighbor unless the OF scores them */
+    virtual const RplNeighbor* GetBestCandidate(const NeighborTable& candidateParents) { return candidateParents.getLowestRank(); }
 
-    virtual Dio* GetBestCandidate(std::map<Ipv6Address, Dio *> candidateParents);
-    double GetBestCandidatePATHCOST (std::map<Ipv6Address, Dio *> candidateParents);
+    /** @return path cost through the best lowest-rank candidate, advertised as the DIO path cost */
+    double GetBestCandidatePATHCOST (const NeighborTable& candidateParents);
 
     /**
      * Calculate node's rank based on the chosen preferred parent [RFC 6550, 3.5].
      *
      * @param preferredParent node's preferred parent properties (rank, address, ...)
-     * represented by last DIO received from it
+     * taken from the last DIO received from it
      * @return updated rank based on the minHopRankIncrease and OF
      */
     //virtual uint16_t calcRank(Dio* preferredParent);
-    virtual double calcRank(Dio* preferredParent);
+    double calcRank(const RplNeighbor* preferredParent);
 
     void setMinHopRankIncrease(int incr) { minHopRankIncrease = incr; }
 
     //virtual uint16_t calcTemp_Rank(const Ptr<const Dio>& dio);  //CL
-    virtual double calcTemp_Rank(const Ptr<const Dio>& dio);  //CL
+    double calcTemp_Rank(const Ptr<const Dio>& dio);  //CL
 
     double ETX_Calculator_onLink(const Ptr<const Dio>& dio); //CL: This one is for using with calcTemp_Rank()
 
-    double ETX_Calculator_onLink_calcRank(Dio* preferredParent); //CL: This one is for using with calcRank()
+    double ETX_Calculator_onLink_calcRank(const RplNeighbor* preferredParent); //CL: This one is for using with calcRank()
 
-    double Tie_breaker_Calculator(Dio* candidate);  //2022-05-18
+    /** @return smoothed on-link ETX of the neighbor with @param nodeId, advanced only by new ACK samples of @param link */
+    double smoothOnLinkEtx(uint64_t nodeId, const NeighborLink *link);
 
-    double Path_Cost_Calculator(Dio* candidate); //2022-10-17
+    double Path_Cost_Calculator(const RplNeighbor* candidate); //2022-10-17
     double Path_Cost_Calculator_ptr(const Ptr<const Dio>& dio);
 
     //Added by CL to cache the count the rcvd msg from specific src Addr
@@ -136,38 +164,122 @@ class ObjectiveFunction : public cSimpleModule
     virtual double Norm_fps (double fps );
     virtual double Norm_etx (double etx);
 
+    /** Model inputs, in this order: bw, den, on-link ETX, fps and drops (DropR + DropB) */
+    static const int ML_FEATURE_COUNT = 5;
+
+    const ObliviousForest *model = nullptr;    // shared by all nodes loading the same modelFile
+
     double ML_rank_calculator(const Ptr<const Dio>& dio);
-    double ML_rank_calculator_FORcalcRank(Dio* preferredParent); //CL: This one is for using with calcRank()
+    double ML_rank_calculator_FORcalcRank(const RplNeighbor* preferredParent); //CL: This one is for using with calcRank()
+
+    /**
+     * ML_rank_calculator_FORcalcRank() for each of @param candidates, evaluating
+     * the model once over all their feature rows
+     */
+    std::vector<double> ML_rank_calculator_batch(const std::vector<const RplNeighbor *>& candidates);
+    std::vector<double> Path_Cost_Calculator_batch(const std::vector<const RplNeighbor *>& candidates);
 
+    /**
+     * Same link costs from the external inference server (1 - predicted probability), see
+     * InferenceClient; the calculators above delegate to them when inferenceServer is set
+     */
     double ML_rank_calculator_SP(const Ptr<const Dio>& dio);
-    double ML_rank_calculator_FORcalcRank_SP(Dio* preferredParent); //CL: This one is for using with calcRank()
-
-    //variable of socket connection
-    /*    WSADATA wsa;
-        SOCKET s;
-        struct sockaddr_in server;
-        const char *message ;
-        char *space = " " ;
-        char server_reply [2000];
-        int recv_size;
-    */
-    //to avoid open the socket connection
-    int prev_metric1 = 0   ;                   //m1-HC
-    double prev_metric2 = 0   ;                   //m2-ETX
-    double prev_metric3 =  0  ;                   //m8-Den
-    double prev_metric4 = 0;              //m14-den
-    int prev_metric5 = 0;                       //m15-etx
-    double prev_metric6 = 0;                //SNR
-    int prev_metric7 =  0;                      //mac losses from dio
-    int prev_metric8 = 0;                 //mac losses from me
-    double prev_response = 0;
+    double ML_rank_calculator_FORcalcRank_SP(const RplNeighbor* preferredParent); //CL: This one is for using with calcRank()
+    std::vector<double> ML_rank_calculator_batch_SP(const std::vector<const RplNeighbor *>& candidates);
+
+    //to avoid open the socket connection: predictions of the inference server by quantized features
+    PredictionCache *predictionCache = nullptr;    // own or shared, see the sharedPredictionCache parameter
+    std::unique_ptr<PredictionCache> localPredictionCache;
+    long predictionCacheHits = 0;
+    long predictionCacheMisses = 0;
+
+    InferenceClient *inferenceClient = nullptr;    // shared by all nodes using the same server, nullptr for the local model
+    long inferenceFailures = 0;
+
+    /** Look @param key up in the prediction cache and count the hit or miss for this node */
+    bool lookupPrediction(const PredictionCache::Key& key, double& prediction);
+
+    /**
+     * Probabilities for @param numRows feature rows, from the prediction cache or
+     * else in one pipelined request to the server; 0 for rows the server didn't answer
+     */
+    void requestPredictions(const double *features, int numRows, double *responses);
 
+    void ML_features_SP(const RplNeighbor *candidate, double *features);
 
   protected:
-    virtual void initialize() override;  //CL
+    /** Parent selection on a non-empty @param candidateParents */
+    virtual const RplNeighbor *selectPreferredParent(const NeighborTable& candidateParents, const RplNeighbor *currentPreferredParent) = 0;
+
+    /** Rank increase over @param parent, over the sender of @param dio */
+    virtual double getRankIncrease(const RplNeighbor *parent) { return 1; }
+    virtual double getTempRankIncrease(const Ptr<const Dio>& dio) { return 1; }
+
+    /**
+     * Path cost through each of @param candidates: its advertised path cost, or
+     * its hop count plus @param staleHops once its DIO is older than @param maxAge,
+     * plus the link part from Path_Cost_Calculator_batch()
+     */
+    std::vector<double> getPathCostsThrough(const std::vector<const RplNeighbor *>& candidates, simtime_t maxAge, int staleHops);
+
+    /** Writes the ML model inputs of @param candidate to @param features */
+    void ML_features(const RplNeighbor *candidate, float *features);
+
+    /** The whole table, and the neighbors sharing the lowest advertised rank only, in address order */
+    std::vector<const RplNeighbor *> getScanOrder(const NeighborTable& candidateParents) const;
+    std::vector<const RplNeighbor *> getLowestRankScanOrder(const NeighborTable& candidateParents) const;
+
+    /**
+     * @return the one of the non-empty @param candidates with the lowest score, @param scores
+     * holding the score of each at the same position; the first among equal scores.
+     * Its score goes to @param lowestScore
+     */
+    const RplNeighbor *getLowestScore(const std::vector<const RplNeighbor *>& candidates, const std::vector<double>& scores, double& lowestScore);
+
+    /**
+     * Same among the lowest-rank group from getLowestRankScanOrder(), with the tie
+     * threshold. With @param traceTies every comparison is written to St_tie-breaker-counter.txt
+     */
+    const RplNeighbor *getLowestRankLowestScore(const std::vector<const RplNeighbor *>& candidates, const std::vector<double>& scores, double& lowestScore, bool traceTies);
+
+    /** getLowestScore() over the whole table with the scores from @param score */
+    template <typename Score>
+    const RplNeighbor *getLowestScore(const NeighborTable& candidateParents, Score score, double& lowestScore);
+
+    /** getLowestRankLowestScore() with the scores from @param score; the other neighbors can't win and aren't scored */
+    template <typename Score>
+    const RplNeighbor *getLowestRankLowestScore(const NeighborTable& candidateParents, Score score, double& lowestScore, bool traceTies);
+
+    void traceTie(double currentScore, double candidateScore);
+
+  protected:
+    virtual int numInitStages() const override { return NUM_INIT_STAGES; }
+    virtual void initialize(int stage) override;  //CL
     void finish() override; //CL
 };
 
+template <typename Score>
+const RplNeighbor *ObjectiveFunction::getLowestScore(const NeighborTable& candidateParents, Score score, double& lowestScore)
+{
+    std::vector<const RplNeighbor *> candidates = getScanOrder(candidateParents);
+    std::vector<double> scores;
+    scores.reserve(candidates.size());
+    for (const RplNeighbor *candidate : candidates)
+        scores.push_back(score(candidate));
+    return getLowestScore(candidates, scores, lowestScore);
+}
+
+template <typename Score>
+const RplNeighbor *ObjectiveFunction::getLowestRankLowestScore(const NeighborTable& candidateParents, Score score, double& lowestScore, bool traceTies)
+{
+    std::vector<const RplNeighbor *> candidates = getLowestRankScanOrder(candidateParents);
+    std::vector<double> scores;
+    scores.reserve(candidates.size());
+    for (const RplNeighbor *candidate : candidates)
+        scores.push_back(score(candidate));
+    return getLowestRankLowestScore(candidates, scores, lowestScore, traceTies);
+}
+
 } // namespace inet
 
 #endif
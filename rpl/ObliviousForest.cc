@@ -0,0 +1,240 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "inet/routing/rpl/ObliviousForest.h"
+
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <numeric>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "inet/routing/rpl/Catboost.h"
+#include "inet/routing/rpl/ObliviousForestFormat.h"
+
+namespace inet {
+
+namespace {
+
+struct ForestArrays
+{
+    std::vector<int> borderCounts;
+    std::vector<float> borders;
+    std::vector<int> treeDepths;
+    std::vector<int> treeSplits;
+    std::vector<double> leafValues;
+};
+
+} // namespace
+
+ObliviousForest::ObliviousForest(int featureCount, std::vector<int> borderCounts, std::vector<float> borders,
+        std::vector<int> treeDepths, std::vector<int> treeSplits, std::vector<double> leafValues,
+        double scale, double bias) :
+    featureCount(featureCount),
+    treeCount(treeDepths.size()),
+    borderCount(borders.size()),
+    scale(scale),
+    bias(bias)
+{
+    if ((int)borderCounts.size() != featureCount)
+        throw cRuntimeError("Oblivious forest: border counts don't match the %d features and %d borders", featureCount, (int)borders.size());
+    size_t numSplits = treeSplits.size(), numLeaves = leafValues.size();
+    auto arrays = std::make_shared<ForestArrays>(ForestArrays { std::move(borderCounts), std::move(borders),
+            std::move(treeDepths), std::move(treeSplits), std::move(leafValues) });
+    this->borderCounts = arrays->borderCounts.data();
+    this->borders = arrays->borders.data();
+    this->treeDepths = arrays->treeDepths.data();
+    this->treeSplits = arrays->treeSplits.data();
+    this->leafValues = arrays->leafValues.data();
+    storage = arrays;
+    checkDimensions(numSplits, numLeaves);
+}
+
+void ObliviousForest::checkDimensions(size_t numSplits, size_t numLeaves) const
+{
+    size_t numBorders = 0;
+    for (int feature = 0; feature < featureCount; feature++) {
+        if (borderCounts[feature] < 0)
+            throw cRuntimeError("Oblivious forest: feature %d has %d borders", feature, borderCounts[feature]);
+        numBorders += borderCounts[feature];
+    }
+    if (numBorders != borderCount)
+        throw cRuntimeError("Oblivious forest: border counts don't match the %d features and %d borders", featureCount, (int)borderCount);
+    size_t splitsOfTrees = 0, leavesOfTrees = 0;
+    for (int tree = 0; tree < treeCount; tree++) {
+        int depth = treeDepths[tree];
+        if (depth < 0 || depth > 16)    // CatBoost's limit
+            throw cRuntimeError("Oblivious forest: tree %d has depth %d", tree, depth);
+        splitsOfTrees += depth;
+        leavesOfTrees += (size_t)1 << depth;
+    }
+    if (splitsOfTrees != numSplits || leavesOfTrees != numLeaves)
+        throw cRuntimeError("Oblivious forest: tree depths don't match %d splits and %d leaf values", (int)numSplits, (int)numLeaves);
+    for (size_t i = 0; i < numSplits; i++)
+        if (treeSplits[i] < 0 || (size_t)treeSplits[i] >= borderCount)
+            throw cRuntimeError("Oblivious forest: split on binarized feature %d, there are %d", treeSplits[i], (int)borderCount);
+}
+
+void ObliviousForest::predict(const float *rows, int numRows, double *predictions) const
+{
+    // binarized features of the block, feature-major so each split reads BLOCK_SIZE adjacent bytes;
+    // the buffer is kept between calls, it only grows for a model with more borders
+    static thread_local std::vector<uint8_t> scratch;
+    if (scratch.size() < borderCount * BLOCK_SIZE)
+        scratch.resize(borderCount * BLOCK_SIZE);
+    uint8_t *bins = scratch.data();
+    for (int blockStart = 0; blockStart < numRows; blockStart += BLOCK_SIZE) {
+        int blockRows = std::min(BLOCK_SIZE, numRows - blockStart);
+        const float *block = rows + (size_t)blockStart * featureCount;
+
+        int bin = 0;
+        for (int feature = 0; feature < featureCount; feature++) {
+            float values[BLOCK_SIZE] = {};
+            for (int row = 0; row < blockRows; row++)
+                values[row] = block[row * featureCount + feature];
+            for (int i = 0; i < borderCounts[feature]; i++, bin++) {
+                float border = borders[bin];
+                uint8_t *out = &bins[bin * BLOCK_SIZE];
+                for (int row = 0; row < BLOCK_SIZE; row++)
+                    out[row] = values[row] > border;
+            }
+        }
+
+        double sums[BLOCK_SIZE] = {};
+        const int *splits = treeSplits;
+        const double *leaves = leafValues;
+        for (int tree = 0; tree < treeCount; tree++) {
+            int depth = treeDepths[tree];
+            uint32_t index[BLOCK_SIZE] = {};
+            for (int level = 0; level < depth; level++) {
+                const uint8_t *split = &bins[splits[level] * BLOCK_SIZE];
+                for (int row = 0; row < BLOCK_SIZE; row++)
+                    index[row] |= (uint32_t)split[row] << level;
+            }
+            for (int row = 0; row < BLOCK_SIZE; row++)
+                sums[row] += leaves[index[row]];
+            splits += depth;
+            leaves += (size_t)1 << depth;
+        }
+
+        for (int row = 0; row < blockRows; row++)
+            predictions[blockStart + row] = scale * sums[row] + bias;
+    }
+}
+
+ObliviousForest ObliviousForest::map(const std::string& fileName)
+{
+    static_assert(sizeof(int) == sizeof(int32_t), "the file's int32_t arrays are used as int arrays");
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw cRuntimeError("Cannot open model file '%s': %s", fileName.c_str(), strerror(errno));
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) < 0 || (size_t)fileStat.st_size < sizeof(ObliviousForestFileHeader)) {
+        close(fd);
+        throw cRuntimeError("Model file '%s' is too short", fileName.c_str());
+    }
+    size_t size = fileStat.st_size;
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        throw cRuntimeError("Cannot map model file '%s': %s", fileName.c_str(), strerror(errno));
+
+    ObliviousForest forest;
+    forest.storage = std::shared_ptr<const void>(mapping, [size] (const void *p) { munmap(const_cast<void *>(p), size); });
+    const char *data = static_cast<const char *>(mapping);
+    const ObliviousForestFileHeader& header = *reinterpret_cast<const ObliviousForestFileHeader *>(data);
+    if (memcmp(header.magic, OBLIVIOUS_FOREST_MAGIC, sizeof(header.magic)) != 0 || header.version != OBLIVIOUS_FOREST_VERSION)
+        throw cRuntimeError("'%s' is not a model file of version %u", fileName.c_str(), OBLIVIOUS_FOREST_VERSION);
+    if (obliviousForestFileSize(header) != size)
+        throw cRuntimeError("Model file '%s' is %d bytes, its header describes %d", fileName.c_str(), (int)size, (int)obliviousForestFileSize(header));
+
+    const char *section = data + sizeof(ObliviousForestFileHeader);
+    forest.leafValues = reinterpret_cast<const double *>(section);
+    section += obliviousForestAlign((size_t)header.leafCount * sizeof(double));
+    forest.borders = reinterpret_cast<const float *>(section);
+    section += obliviousForestAlign((size_t)header.borderCount * sizeof(float));
+    forest.borderCounts = reinterpret_cast<const int *>(section);
+    section += obliviousForestAlign((size_t)header.featureCount * sizeof(int32_t));
+    forest.treeDepths = reinterpret_cast<const int *>(section);
+    section += obliviousForestAlign((size_t)header.treeCount * sizeof(int32_t));
+    forest.treeSplits = reinterpret_cast<const int *>(section);
+
+    forest.featureCount = header.featureCount;
+    forest.treeCount = header.treeCount;
+    forest.borderCount = header.borderCount;
+    forest.scale = header.scale;
+    forest.bias = header.bias;
+    forest.checkDimensions(header.splitCount, header.leafCount);
+    return forest;
+}
+
+const ObliviousForest& ObliviousForest::getShared(const std::string& fileName)
+{
+    if (fileName.empty())
+        return getCompiledModel();
+    static std::map<std::string, std::unique_ptr<ObliviousForest>> forests;
+    auto& forest = forests[fileName];
+    if (!forest)
+        forest.reset(new ObliviousForest(map(fileName)));
+    return *forest;
+}
+
+namespace {
+
+// exports of different CatBoost versions store one leaf value per leaf or one per
+// leaf and model dimension, and a single bias or one per dimension
+template <size_t N>
+double leafValue(const double (&values)[N], size_t leaf) { return values[leaf]; }
+
+template <size_t N, size_t D>
+double leafValue(const double (&values)[N][D], size_t leaf) { return values[leaf][0]; }
+
+template <typename Model>
+auto modelBias(const Model& model, int) -> decltype((double)model.Biases[0]) { return model.Biases[0]; }
+
+template <typename Model>
+double modelBias(const Model& model, long) { return model.Bias; }
+
+} // namespace
+
+const ObliviousForest& ObliviousForest::getCompiledModel()
+{
+    static const ObliviousForest forest = [] {
+        const auto& model = CatboostModelStatic;
+        std::vector<int> borderCounts(model.BorderCounts, model.BorderCounts + model.FloatFeatureCount);
+        std::vector<float> borders(model.Borders, model.Borders + model.BinaryFeatureCount);
+        std::vector<int> treeDepths(model.TreeDepth, model.TreeDepth + model.TreeCount);
+        std::vector<int> treeSplits(model.TreeSplits, model.TreeSplits + std::accumulate(treeDepths.begin(), treeDepths.end(), 0));
+        std::vector<double> leafValues;
+        for (int depth : treeDepths)
+            for (size_t i = 0; i < (size_t)1 << depth; i++)
+                leafValues.push_back(leafValue(model.LeafValues, leafValues.size()));
+        return ObliviousForest(model.FloatFeatureCount, std::move(borderCounts), std::move(borders),
+                std::move(treeDepths), std::move(treeSplits), std::move(leafValues), model.Scale, modelBias(model, 0));
+    }();
+    return forest;
+}
+
+} // namespace inet
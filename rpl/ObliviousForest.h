@@ -0,0 +1,100 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _OBLIVIOUSFOREST_H
+#define _OBLIVIOUSFOREST_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "inet/common/INETDefs.h"
+
+namespace inet {
+
+/**
+ * Ensemble of oblivious decision trees, the model format CatBoost exports,
+ * scored on batches of feature rows. All nodes of one tree level split on the
+ * same binarized feature, so rows are processed in blocks of BLOCK_SIZE: the
+ * features of a block are binarized once, then every tree walks the whole
+ * block level by level. The per-row loops are branch-free and contiguous,
+ * which lets the compiler vectorize them across the rows.
+ *
+ * Rows are summed tree by tree in the same order as CatBoost's generated
+ * ApplyCatboostModel(), so predictions are identical to it.
+ *
+ * The arrays are read-only views into storage shared by all copies: vectors
+ * for a forest built in memory, the mapping of the file for one loaded with
+ * map(). getShared() hands out one forest per model file for the whole process.
+ */
+class INET_API ObliviousForest
+{
+  public:
+    static const int BLOCK_SIZE = 8;
+
+  private:
+    int featureCount = 0;
+    int treeCount = 0;
+    size_t borderCount = 0;
+    const int *borderCounts = nullptr;    // borders per feature
+    const float *borders = nullptr;       // all features' borders, in feature order
+    const int *treeDepths = nullptr;
+    const int *treeSplits = nullptr;      // binarized feature index per tree level, trees concatenated
+    const double *leafValues = nullptr;   // 2^depth leaves per tree, trees concatenated
+    double scale = 1;
+    double bias = 0;
+    std::shared_ptr<const void> storage;  // owns what the arrays point into
+
+    /** Throws unless the arrays hold @param numSplits splits and @param numLeaves leaves */
+    void checkDimensions(size_t numSplits, size_t numLeaves) const;
+
+  public:
+    ObliviousForest() {}
+    ObliviousForest(int featureCount, std::vector<int> borderCounts, std::vector<float> borders,
+            std::vector<int> treeDepths, std::vector<int> treeSplits, std::vector<double> leafValues,
+            double scale, double bias);
+
+    int getFeatureCount() const { return featureCount; }
+    int getTreeCount() const { return treeCount; }
+
+    /**
+     * Score @param numRows rows of getFeatureCount() features each, stored
+     * row after row in @param rows, into @param predictions
+     */
+    void predict(const float *rows, int numRows, double *predictions) const;
+    double predict(const float *row) const { double prediction; predict(row, 1, &prediction); return prediction; }
+
+    /** @return forest of the model compiled in from Catboost.h, converted on first use */
+    static const ObliviousForest& getCompiledModel();
+
+    /** @return forest evaluated in place from a read-only mapping of @param fileName, see ObliviousForestFormat.h */
+    static ObliviousForest map(const std::string& fileName);
+
+    /**
+     * @return the forest of @param fileName, mapped once per process and then
+     * shared by all callers; the compiled-in model for an empty name
+     */
+    static const ObliviousForest& getShared(const std::string& fileName);
+};
+
+} // namespace inet
+
+#endif
@@ -0,0 +1,79 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * On-disk layout of a serialized ObliviousForest (the modelFile parameter of the
+ * objective functions). This header has no OMNeT++ dependencies, so it is
+ * shared with tools/ForestExport.cc, which writes such files.
+ *
+ * All values are stored in host byte order. The file is mapped read-only and the
+ * forest evaluates straight from the mapping, so every array starts 8 byte
+ * aligned: an ObliviousForestFileHeader is followed by
+ *
+ *   leaf values:   double[leafCount], 2^depth per tree, trees concatenated
+ *   borders:       float[borderCount], all features' borders in feature order
+ *   border counts: int32_t[featureCount]
+ *   tree depths:   int32_t[treeCount]
+ *   tree splits:   int32_t[splitCount], binarized feature per tree level
+ *
+ * each padded to 8 bytes.
+ */
+
+#ifndef _OBLIVIOUSFORESTFORMAT_H
+#define _OBLIVIOUSFORESTFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace inet {
+
+struct ObliviousForestFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t featureCount;
+    uint32_t borderCount;
+    uint32_t treeCount;
+    uint32_t splitCount;
+    uint32_t leafCount;
+    double scale;
+    double bias;
+};
+
+static const char OBLIVIOUS_FOREST_MAGIC[8] = { 'S', 'T', 'F', 'O', 'R', 'S', 'T', '\0' };
+static const uint32_t OBLIVIOUS_FOREST_VERSION = 1;
+
+inline size_t obliviousForestAlign(size_t length) { return (length + 7) & ~(size_t)7; }
+
+/** @return size of a file holding a forest of these dimensions */
+inline size_t obliviousForestFileSize(const ObliviousForestFileHeader& header)
+{
+    return sizeof(ObliviousForestFileHeader)
+            + obliviousForestAlign((size_t)header.leafCount * sizeof(double))
+            + obliviousForestAlign((size_t)header.borderCount * sizeof(float))
+            + obliviousForestAlign((size_t)header.featureCount * sizeof(int32_t))
+            + obliviousForestAlign((size_t)header.treeCount * sizeof(int32_t))
+            + obliviousForestAlign((size_t)header.splitCount * sizeof(int32_t));
+}
+
+} // namespace inet
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "inet/routing/rpl/PacketTrace.h"
+
+namespace inet {
+
+Register_PerRunConfigOption(CFGID_PACKET_TRACE_FORMAT, "packet-trace-format", CFG_STRING, "text",
+        "Format of the packet trace: 'text' appends rows to St_packet-tracer.txt, "
+        "'binary' writes column blocks to St_packet-tracer.bin.");
+
+namespace {
+
+// Same order as the fields of the text trace
+const std::vector<TraceColumn> packetTraceColumns = {
+    { "time", PT_SIMTIME },
+    { "node", PT_STRING },
+    { "event", PT_STRING },
+    { "packet", PT_STRING },
+    { "hc", PT_INT32 },
+    { "etx", PT_DOUBLE },
+    { "dropB", PT_INT32 },
+    { "dropR", PT_INT32 },
+    { "txF", PT_DOUBLE },
+    { "rxF", PT_DOUBLE },
+    { "bw", PT_DOUBLE },
+    { "den", PT_INT32 },
+    { "qu", PT_DOUBLE },
+    { "chUtil", PT_DOUBLE },
+    { "macQu", PT_DOUBLE },
+    { "failRetry", PT_DOUBLE },
+    { "failCong", PT_DOUBLE },
+    { "neighbors", PT_INT32 },
+    { "etxInst", PT_DOUBLE },
+    { "fps", PT_DOUBLE },
+    { "lastUpdate", PT_SIMTIME },
+    { "snr", PT_DOUBLE },
+    { "snrInst", PT_DOUBLE },
+    { "rxRate", PT_DOUBLE },
+};
+
+} // namespace
+
+PacketTrace::PacketTrace() :
+    blocks(packetTraceColumns, ROWS_PER_BLOCK)
+{
+    TraceSink::getInstance().addProducer(this);
+}
+
+PacketTrace::~PacketTrace()
+{
+    blocks.flushBlock();
+    TraceSink::getInstance().removeProducer(this);
+}
+
+PacketTrace& PacketTrace::getInstance()
+{
+    static PacketTrace instance;
+    return instance;
+}
+
+void PacketTrace::resolveFormat()
+{
+    std::string name = getEnvir()->getConfig()->getAsString(CFGID_PACKET_TRACE_FORMAT);
+    if (name == "text") {
+        format = FORMAT_TEXT;
+        channel = TraceSink::getInstance().getChannel("St_packet-tracer.txt");
+    }
+    else if (name == "binary") {
+        format = FORMAT_BINARY;
+        blocks.open("St_packet-tracer.bin");
+    }
+    else
+        throw cRuntimeError("Unknown packet-trace-format '%s', expected 'text' or 'binary'", name.c_str());
+}
+
+void PacketTrace::record(const PacketTraceRecord& record)
+{
+    if (format == FORMAT_UNRESOLVED)
+        resolveFormat();
+
+    if (format == FORMAT_TEXT)
+        writeText(record);
+    else
+        writeBinary(record);
+}
+
+void PacketTrace::recordHeader(const std::string& header)
+{
+    if (format == FORMAT_UNRESOLVED)
+        resolveFormat();
+
+    if (format == FORMAT_TEXT)
+        TraceLine(channel) << header << endl;
+}
+
+void PacketTrace::writeText(const PacketTraceRecord& r)
+{
+    TraceLine(channel) << r.time << " " << r.node << " " << r.event << " " << r.packet << " " <<
+            r.hc << " " << r.etx << " " << r.dropB << " " <<
+            r.dropR << " " << r.txF << " " << r.rxF << " " <<
+            r.bw << " " << r.den << " " << r.qu << " " <<
+            r.chUtil << " " << r.macQu << " " <<
+            r.failRetry << " " << r.failCong << " " <<
+            r.neighbors << " " << r.etxInst << " " <<
+            r.fps << " " << r.lastUpdate << " " << r.snr <<
+            " " << r.snrInst << " " << r.rxRate << endl;
+}
+
+void PacketTrace::writeBinary(const PacketTraceRecord& r)
+{
+    blocks.putSimtime(r.time);
+    blocks.putString(r.node);
+    blocks.putString(r.event);
+    blocks.putString(r.packet);
+    blocks.put<int32_t>(r.hc);
+    blocks.put<double>(r.etx);
+    blocks.put<int32_t>(r.dropB);
+    blocks.put<int32_t>(r.dropR);
+    blocks.put<double>(r.txF);
+    blocks.put<double>(r.rxF);
+    blocks.put<double>(r.bw);
+    blocks.put<int32_t>(r.den);
+    blocks.put<double>(r.qu);
+    blocks.put<double>(r.chUtil);
+    blocks.put<double>(r.macQu);
+    blocks.put<double>(r.failRetry);
+    blocks.put<double>(r.failCong);
+    blocks.put<int32_t>(r.neighbors);
+    blocks.put<double>(r.etxInst);
+    blocks.put<double>(r.fps);
+    blocks.putSimtime(r.lastUpdate);
+    blocks.put<double>(r.snr);
+    blocks.put<double>(r.snrInst);
+    blocks.put<double>(r.rxRate);
+    blocks.endRow();
+}
+
+void PacketTrace::flushTrace(bool endOfRun)
+{
+    // blocks carry their own row count, so a partial block is fine here
+    if (format == FORMAT_BINARY)
+        blocks.flushBlock();
+    if (endOfRun)
+        format = FORMAT_UNRESOLVED;
+}
+
+} // namespace inet
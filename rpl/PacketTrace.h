@@ -0,0 +1,108 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PACKETTRACE_H
+#define _PACKETTRACE_H
+
+#include "inet/common/INETDefs.h"
+#include "inet/routing/rpl/ColumnBlockWriter.h"
+#include "inet/routing/rpl/TraceSink.h"
+
+namespace inet {
+
+/**
+ * One row of the packet trace, written when a data packet is sent (pkt_sent),
+ * forwarded (pkt_frwd) or received at the sink (pkt_rcv). Values are stored as
+ * given, so callers round them the same way as in the text trace.
+ */
+struct PacketTraceRecord
+{
+    simtime_t time;
+    const char *node = "";
+    const char *event = "";
+    const char *packet = "";
+    int hc = 0;
+    double etx = 0;
+    int dropB = 0;
+    int dropR = 0;
+    double txF = 0;
+    double rxF = 0;
+    double bw = 0;
+    int den = 0;
+    double qu = 0;
+    double chUtil = 0;
+    double macQu = 0;
+    double failRetry = 0;
+    double failCong = 0;
+    int neighbors = 0;
+    double etxInst = 0;
+    double fps = 0;
+    simtime_t lastUpdate;
+    double snr = 0;
+    double snrInst = 0;
+    double rxRate = 0;
+};
+
+/**
+ * Writer of St_packet-tracer. Depending on the packet-trace-format
+ * configuration option the rows go either to St_packet-tracer.txt in the usual
+ * space separated layout, or to St_packet-tracer.bin as column blocks (see
+ * PacketTraceFormat.h), which tools/PacketTraceConvert turns back into text or CSV.
+ */
+class INET_API PacketTrace : public ITraceProducer
+{
+  private:
+    enum Format { FORMAT_UNRESOLVED, FORMAT_TEXT, FORMAT_BINARY };
+
+    static const uint32_t ROWS_PER_BLOCK = 4096;
+
+    Format format = FORMAT_UNRESOLVED;
+    TraceChannel *channel = nullptr;
+    ColumnBlockWriter blocks;
+
+    PacketTrace();
+    virtual ~PacketTrace();
+
+    void resolveFormat();
+    void writeText(const PacketTraceRecord& record);
+    void writeBinary(const PacketTraceRecord& record);
+
+  public:
+    static PacketTrace& getInstance();
+
+    /**
+     * Appends one row to the packet trace of the current run.
+     */
+    void record(const PacketTraceRecord& record);
+
+    /**
+     * Appends a free-form line describing the run (e.g. the sink's scenario
+     * summary) to the text trace. The binary trace describes itself through its
+     * column schema, so the line is dropped there.
+     */
+    void recordHeader(const std::string& header);
+
+    virtual void flushTrace(bool endOfRun) override;
+};
+
+} // namespace inet
+
+#endif
@@ -0,0 +1,103 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * On-disk layout of the binary packet trace (St_packet-tracer.bin). This header
+ * has no OMNeT++ dependencies, so it is shared with tools/PacketTraceConvert.cc.
+ *
+ * All values are stored in host byte order (little endian on every platform we
+ * run on). The file starts with a PacketTraceFileHeader followed by numColumns
+ * PacketTraceColumnHeader entries, which form the schema. The rest of the file
+ * is a sequence of blocks; every block holds up to rowsPerBlock rows:
+ *
+ *   PacketTraceBlockHeader
+ *   column 0: numRows values of its width, padded to 8 bytes
+ *   ...
+ *   column n-1
+ *   string heap: heapSize bytes of zero terminated strings, padded to 8 bytes
+ *
+ * String columns hold byte offsets into the heap of their own block, simtime
+ * columns hold the raw 64 bit SimTime value (scaled by simtimeScaleExp), so the
+ * converter can reproduce the text layout exactly.
+ */
+
+#ifndef _PACKETTRACEFORMAT_H
+#define _PACKETTRACEFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace inet {
+
+enum PacketTraceColumnType : uint8_t {
+    PT_SIMTIME = 1,     // int64_t raw simtime
+    PT_STRING = 2,      // uint32_t offset into the block's string heap
+    PT_INT32 = 3,       // int32_t
+    PT_DOUBLE = 4,      // double
+    PT_INT64 = 5,       // int64_t
+};
+
+struct PacketTraceFileHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t numColumns;
+    int32_t simtimeScaleExp;
+    uint32_t rowsPerBlock;
+};
+
+struct PacketTraceColumnHeader
+{
+    char name[24];
+    uint8_t type;
+    uint8_t width;
+    uint8_t reserved[6];
+};
+
+struct PacketTraceBlockHeader
+{
+    uint32_t magic;
+    uint32_t numRows;
+    uint32_t heapSize;
+    uint32_t reserved;
+};
+
+static const char PACKET_TRACE_MAGIC[8] = { 'S', 'T', 'P', 'K', 'T', 'R', 'C', '\0' };
+static const uint32_t PACKET_TRACE_VERSION = 1;
+static const uint32_t PACKET_TRACE_BLOCK_MAGIC = 0x4B4C4250;    // "PBLK"
+
+inline size_t packetTraceAlign(size_t length) { return (length + 7) & ~(size_t)7; }
+
+inline uint8_t packetTraceColumnWidth(uint8_t type)
+{
+    switch (type) {
+        case PT_SIMTIME: return 8;
+        case PT_STRING: return 4;
+        case PT_INT32: return 4;
+        case PT_DOUBLE: return 8;
+        case PT_INT64: return 8;
+        default: return 0;
+    }
+}
+
+} // namespace inet
+
+#endif
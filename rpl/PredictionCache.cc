@@ -0,0 +1,116 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "inet/routing/rpl/PredictionCache.h"
+
+#include <cmath>
+#include <memory>
+
+namespace inet {
+
+namespace {
+
+/**
+ * Owns the shared cache and drops it when the next network is set up, so a
+ * run never sees the predictions or the capacity of the previous one.
+ */
+class SharedPredictionCache : public cISimulationLifecycleListener
+{
+  public:
+    std::unique_ptr<PredictionCache> cache;
+    bool listening = false;
+
+    virtual void lifecycleEvent(SimulationLifecycleEventType eventType, cObject *details) override
+    {
+        if (eventType == LF_PRE_NETWORK_SETUP)
+            cache.reset();
+    }
+
+    virtual void listenerRemoved() override { listening = false; }
+};
+
+SharedPredictionCache shared;
+
+} // namespace
+
+size_t PredictionCache::KeyHash::operator()(const Key& key) const
+{
+    size_t hash = 0;
+    for (int64_t value : key)
+        hash = hash * 31 + std::hash<int64_t>()(value);
+    return hash;
+}
+
+PredictionCache::Key PredictionCache::quantize(const double *features)
+{
+    Key key;
+    for (int i = 0; i < FEATURE_COUNT; i++)
+        key[i] = std::llround(features[i] * 100);
+    return key;
+}
+
+bool PredictionCache::lookup(const Key& key, double& prediction)
+{
+    auto it = index.find(key);
+    if (it == index.end()) {
+        misses++;
+        return false;
+    }
+    hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    prediction = it->second->second;
+    return true;
+}
+
+void PredictionCache::insert(const Key& key, double prediction)
+{
+    if (capacity == 0)
+        return;
+    auto it = index.find(key);
+    if (it != index.end()) {
+        it->second->second = prediction;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    if (entries.size() == capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+    entries.emplace_front(key, prediction);
+    index[key] = entries.begin();
+}
+
+PredictionCache& PredictionCache::getShared(size_t capacity)
+{
+    if (!shared.listening && getEnvir()) {
+        getEnvir()->addLifecycleListener(&shared);
+        shared.listening = true;
+    }
+    if (!shared.cache)
+        shared.cache.reset(new PredictionCache(capacity));
+    else if (shared.cache->getCapacity() != capacity)
+        throw cRuntimeError("The shared prediction cache holds %zu entries, predictionCacheSize = %zu conflicts with it; "
+                "use the same predictionCacheSize on all nodes or disable sharedPredictionCache",
+                shared.cache->getCapacity(), capacity);
+    return *shared.cache;
+}
+
+} // namespace inet
@@ -0,0 +1,92 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _PREDICTIONCACHE_H
+#define _PREDICTIONCACHE_H
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+#include "inet/common/INETDefs.h"
+
+namespace inet {
+
+/**
+ * Least-recently-used cache of ML rank predictions. It is keyed by the
+ * feature tuple quantized to the 0.01 precision the features are sent to the
+ * inference server with, so DIOs that only differ by noise below that
+ * precision share one prediction.
+ *
+ * A node can keep its own cache or use the process-wide one from getShared(),
+ * which every node of the network fills and reads. The shared cache lives for
+ * one run only; the next network setup starts with an empty one.
+ */
+class INET_API PredictionCache
+{
+  public:
+    static const int FEATURE_COUNT = 5;
+    typedef std::array<int64_t, FEATURE_COUNT> Key;
+
+  private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+    typedef std::list<std::pair<Key, double>> Entries;
+
+    size_t capacity;
+    Entries entries;    // most recently used first
+    std::unordered_map<Key, Entries::iterator, KeyHash> index;
+    long hits = 0;
+    long misses = 0;
+
+  public:
+    explicit PredictionCache(size_t capacity) : capacity(capacity) {}
+
+    /** @return @param features rounded to 0.01, in units of 0.01 */
+    static Key quantize(const double *features);
+
+    /**
+     * Look @param key up, a hit becomes the most recently used entry
+     * @return true and the cached prediction in @param prediction on a hit
+     */
+    bool lookup(const Key& key, double& prediction);
+
+    /** Store @param prediction for @param key, evicting the least recently used entry when full */
+    void insert(const Key& key, double prediction);
+
+    size_t getCapacity() const { return capacity; }
+    size_t size() const { return entries.size(); }
+    long getHits() const { return hits; }
+    long getMisses() const { return misses; }
+    double getHitRate() const { return hits + misses == 0 ? 0 : (double)hits / (hits + misses); }
+
+    /**
+     * @return the cache shared by all nodes of the current run, created with
+     * @param capacity on first use; every node must ask for the same capacity
+     */
+    static PredictionCache& getShared(size_t capacity);
+};
+
+} // namespace inet
+
+#endif
@@ -28,6 +28,7 @@
 #include <math.h>
 
 #include "inet/routing/rpl/Rpl.h"
+#include "inet/common/packet/chunk/SequenceChunk.h"
 
 #include <fstream>
 #include <iostream>
@@ -36,6 +37,9 @@
 #include <iomanip>
 
 #include "inet/routing/rpl/ObjectiveFunction.h" //2022-04-28 to avoid circular dependency
+#include "inet/routing/rpl/FeatureExport.h"
+#include "inet/routing/rpl/HostBindings.h"
+#include "inet/routing/rpl/TraceSink.h"
 
 //#include <Python.h>
 //#include "C:/Users/carlo/Anaconda3/Python.h"
@@ -53,13 +57,6 @@ std::ostream& operator<<(std::ostream& os, std::vector<Ipv6Address> &list)
     return os;
 }
 
-std::ostream& operator<<(std::ostream& os, std::map<Ipv6Address, std::pair<cMessage *, uint8_t>> acks)
-{
-    for (auto a : acks)
-        os << a.first << " (" << a.second.second << " attempts), timeout event - " << a.second.first << endl;
-    return os;
-}
-
 // TODO: Store DODAG-related info in a separate object
 // TODO: Refactor utility functions out
 
@@ -69,12 +66,12 @@ Rpl::Rpl() :
     daoDelay(DEFAULT_DAO_DELAY),
     hasStarted(false),
     daoAckTimeout(10),
+    daoAckTimeoutEvent(nullptr),
     daoRtxCtn(0),
     detachedTimeout(2), // manually suppressing previous DODAG info [RFC 6550, 8.2.2.1]
     daoSeqNum(0),
     prefixLength(128),
     preferredParent(nullptr),
-    objectiveFunctionType("hopCount"),
     dodagColor(cFigure::BLACK),
     floating(false),
     prefParentConnector(nullptr),
@@ -97,6 +94,18 @@ void Rpl::initialize(int stage)
     RoutingProtocolBase::initialize(stage);
 
     if (stage == INITSTAGE_LOCAL) {
+        // unknown ini keys are ignored, so an old objectiveFunctionType setting would silently run hop count
+        std::string objectiveFunctionType = par("objectiveFunctionType").stdstringValue();
+        if (!objectiveFunctionType.empty()) {
+            static const std::map<std::string, std::string> plugins = {
+                { "hopCount", "HopCountObjectiveFunction" }, { "HOP_COUNT", "HopCountObjectiveFunction" },
+                { "ETX", "EtxObjectiveFunction" }, { "HC_MOD", "HcModObjectiveFunction" }, { "ML", "MlObjectiveFunction" },
+                { "RPL_ENH", "RplEnhObjectiveFunction" }, { "RPL_ENH2", "RplEnh2ObjectiveFunction" }
+            };
+            auto plugin = plugins.find(objectiveFunctionType);
+            throw cRuntimeError("objectiveFunctionType is no longer supported, select the objective function with "
+                    "**.objectiveFunction.typename = \"%s\" instead", plugin != plugins.end() ? plugin->second.c_str() : "<plugin>ObjectiveFunction");
+        }
         interfaceTable = getModuleFromPar<IInterfaceTable>(par("interfaceTableModule"), this);
         networkProtocol = getModuleFromPar<INetfilter>(par("networkProtocolModule"), this);
         nd = check_and_cast<Ipv6NeighbourDiscovery*>(getModuleByPath("^.ipv6.neighbourDiscovery"));
@@ -107,9 +116,10 @@ void Rpl::initialize(int stage)
         daoEnabled = par("daoEnabled").boolValue();
         host = getContainingNode(this);
 
-        objectiveFunction = new ObjectiveFunction(par("objectiveFunctionType").stdstringValue());
-        objectiveFunction->setMinHopRankIncrease(par("minHopRankIncrease").intValue());
         daoRtxThresh = par("numDaoRetransmitAttempts").intValue();
+        pendingDaoAcks.setResolution(par("daoAckTimerResolution").doubleValue());
+        daoAggregationWindow = par("daoAggregationWindow").doubleValue();
+        daoAggregationMaxTargets = par("daoAggregationMaxTargets").intValue();
         allowDodagSwitching = par("allowDodagSwitching").boolValue();
         pDaoAckEnabled = par("daoAckEnabled").boolValue();
         pUseWarmup = par("useWarmup").boolValue();
@@ -118,6 +128,12 @@ void Rpl::initialize(int stage)
         dioReceivedSignal = registerSignal("dioReceived");
         daoReceivedSignal = registerSignal("daoReceived");
         parentUnreachableSignal = registerSignal("parentUnreachable");
+        parentChangedSignal = registerSignal("parentChanged");
+        rankSignal = registerSignal("rank");
+        pathCostSignal = registerSignal("pathCost");
+        hopCountSignal = registerSignal("hopCount");
+        etxSignal = registerSignal("etx");
+        neighborsSignal = registerSignal("neighbors");
 
         DIOsent.setName("DIOsent");  //CL 2021-08-05
         DAOsent.setName("DAOsent");  //CL 2021-08-05
@@ -127,11 +143,26 @@ void Rpl::initialize(int stage)
         WATCH(numParentUpdates);
 
 
+    }
+    else if (stage == INITSTAGE_NETWORK_LAYER) {
+        // MAC, radio and OF are bound once here instead of looked up per DIO
+        auto bindings = HostBindings::get(this);
+        mac = bindings->getMac();
+        radio = bindings->getRadio();
+        objectiveFunction = bindings->getObjectiveFunction();
+        objectiveFunction->setMinHopRankIncrease(par("minHopRankIncrease").intValue());
+        // metrics the OF never reads are neither computed for the DIOs nor kept per neighbor,
+        // except when the feature export needs all of them for its link features
+        bool allMetrics = par("trackAllMetrics").boolValue() || FeatureExport::getInstance().isEnabled();
+        metrics = allMetrics ? RPL_METRICS_ALL : objectiveFunction->getRequiredMetrics();
+        candidateParents.setMetrics(metrics);
+        backupParents.setMetrics(metrics);
     }
     else if (stage == INITSTAGE_ROUTING_PROTOCOLS) {
         registerService(Protocol::manet, nullptr, gate("ipIn"));
         registerProtocol(Protocol::manet, gate("ipOut"), nullptr);
         host->subscribe(linkBrokenSignal, this);
+        host->subscribe(routeDeletedSignal, this);
         networkProtocol->registerHook(0, this);
     }
 
@@ -207,7 +238,7 @@ void Rpl::start()
     isRoot = par("isRoot").boolValue(); // Initialization of this parameter should be here to ensure
                                         // multi-gateway configurator will have time to assign 'root' roles
                                         // to randomly chosen nodes
-    position = *(new Coord());
+    position = Coord();
 
     // set network interface entry pointer (TODO: Update for IEEE 802.15.4)
     for (int i = 0; i < interfaceTable->getNumInterfaces(); i++)
@@ -228,6 +259,7 @@ void Rpl::start()
 
     rank = INF_RANK - 1;
     detachedTimeoutEvent = new cMessage("", DETACHED_TIMEOUT);
+    daoAckTimeoutEvent = new cMessage("DAO_ACK timeouts", DAO_ACK_TIMEOUT);
 
     // Metrics updater timer:
     metric_updater_timer = new cMessage("time for update metrics", METRIC_TIMER);  //CL 2022-02-19
@@ -259,6 +291,12 @@ void Rpl::refreshDisplay() const {
 void Rpl::stop()
 {
     cancelAndDelete(detachedTimeoutEvent);
+    cancelAndDelete(daoAggregationTimer);
+    daoAggregationTimer = nullptr;
+    cancelAndDelete(daoAckTimeoutEvent);
+    daoAckTimeoutEvent = nullptr;
+    pendingDaoAcks.clear();
+    pendingAggregatedDaos.clear();
     //cancelAndDelete(metric_updater_timer);  //CL 2022-02-19
 
 }
@@ -286,17 +324,18 @@ void Rpl::processSelfMessage(cMessage *message)
             break;
         }
         case DAO_ACK_TIMEOUT: {
-            Ipv6Address *advDest = (Ipv6Address*) message->getContextPointer();
-            if (pendingDaoAcks.find(*advDest) == pendingDaoAcks.end())
-                EV_WARN << "Received DAO_ACK timeout for deleted entry, ignoring" << endl;
-            else
-                retransmitDao(*advDest);
-            break;
+            processDaoAckTimeouts();
+            return; // the event is reused for every tick
         }
         case METRIC_TIMER: {
             updateMetrics_frequently();
             break;
         }
+        case DAO_AGGREGATION: {
+            daoAggregationTimer = nullptr;
+            sendAggregatedDaos();
+            break;
+        }
         default: EV_WARN << "Unknown self-message received - " << message << endl;
 
     //CL 22-02-22
@@ -308,34 +347,115 @@ void Rpl::processSelfMessage(cMessage *message)
 }
 
 void Rpl::clearDaoAckTimer(Ipv6Address daoDest) {
-    if (pendingDaoAcks.count(daoDest))
-        if (pendingDaoAcks[daoDest].first && pendingDaoAcks[daoDest].first->isSelfMessage())
-            cancelEvent(pendingDaoAcks[daoDest].first);
+    // nothing to cancel, the wheel drops the stale slot reference on its own
     pendingDaoAcks.erase(daoDest);
+    pendingAggregatedDaos.erase(daoDest);
+    if (!pendingDaoAcks.isArmed())
+        cancelEvent(daoAckTimeoutEvent);
+}
+
+void Rpl::scheduleDaoAckTimeout() {
+    // one event at the earliest armed timeout, an earlier one that finds nothing due just reschedules
+    simtime_t deadline = pendingDaoAcks.getNextDeadline();
+    if (!daoAckTimeoutEvent->isScheduled() || daoAckTimeoutEvent->getArrivalTime() > deadline)
+        rescheduleAt(deadline, daoAckTimeoutEvent);
+}
+
+void Rpl::processDaoAckTimeouts() {
+    std::vector<Ipv6Address> expired;
+    pendingDaoAcks.advance(simTime(), expired);
+    if (!expired.empty())
+        retransmitDaos(expired);
+    if (pendingDaoAcks.isArmed())
+        scheduleDaoAckTimeout();
 }
 
-void Rpl::retransmitDao(Ipv6Address advDest) {
-    EV_DETAIL << "DAO_ACK for " << advDest << " timed out, attempting retransmit" << endl;
+void Rpl::retransmitDaos(const std::vector<Ipv6Address> &advDests) {
+    EV_DETAIL << "DAO_ACK for " << advDests.size() << " DAOs timed out, attempting retransmit" << endl;
 
     if (!preferredParent) {
         EV_WARN << "Preferred parent not set, cannot retransmit DAO"
                 << "erasing entry from pendingDaoAcks " << endl;
-        clearDaoAckTimer(advDest);
+        for (const auto& advDest : advDests)
+            clearDaoAckTimer(advDest);
         return;
     }
 
-    auto rtxCtn = pendingDaoAcks[advDest].second++;
-    if (rtxCtn > daoRtxThresh) {
-        EV_DETAIL << "Retransmission threshold (" << std::to_string(daoRtxThresh)
-            << ") exceeded, erasing corresponding entry from pending ACKs" << endl;
+    std::vector<Ipv6Address> targets;
+    int retries = 0;
+    for (const auto& advDest : advDests) {
+        auto rtxCtn = pendingDaoAcks.addRetry(advDest) - 1;
+        if (rtxCtn > daoRtxThresh) {
+            EV_DETAIL << "Retransmission threshold (" << std::to_string(daoRtxThresh)
+                << ") exceeded for " << advDest << ", erasing corresponding entry from pending ACKs" << endl;
+            clearDaoAckTimer(advDest);
+            numDaoDropped++;
+            continue;
+        }
+
+        EV_DETAIL << advDest << " (" << std::to_string(rtxCtn) << " attempt)" << endl;
+
+        auto aggregatedDao = pendingAggregatedDaos.find(advDest);
+        if (!storing) {
+            if (aggregatedDao != pendingAggregatedDaos.end())
+                sendRplPacket(createDao(aggregatedDao->second), DAO, preferredParent->getSrcAddress(), daoDelay);
+            else
+                sendRplPacket(createDao(advDest), DAO, preferredParent->getSrcAddress(), daoDelay);
+            continue;
+        }
+
+        // storing mode: merge into one DAO, acknowledged (and counted) under its first target
+        if (aggregatedDao != pendingAggregatedDaos.end())
+            targets.insert(targets.end(), aggregatedDao->second.begin(), aggregatedDao->second.end());
+        else
+            targets.push_back(advDest);
+        retries = std::max(retries, rtxCtn + 1);
         clearDaoAckTimer(advDest);
-        numDaoDropped++;
+    }
+
+    if (!targets.empty())
+        sendMultiTargetDaos(targets, daoDelay, retries);
+}
+
+void Rpl::aggregateDaoTargets(const std::vector<Ipv6Address> &targets) {
+    aggregatedTargets.insert(aggregatedTargets.end(), targets.begin(), targets.end());
+    if (!daoAggregationTimer) {
+        daoAggregationTimer = new cMessage("DAO aggregation", DAO_AGGREGATION);
+        scheduleAt(simTime() + daoAggregationWindow, daoAggregationTimer);
+    }
+    EV_DETAIL << "Aggregating DAO targets, " << aggregatedTargets.size()
+            << " pending until " << daoAggregationTimer->getArrivalTime() << endl;
+}
+
+void Rpl::sendAggregatedDaos() {
+    if (!preferredParent) {
+        EV_WARN << "Preferred parent not set, dropping " << aggregatedTargets.size()
+                << " aggregated DAO targets" << endl;
+        aggregatedTargets.clear();
         return;
     }
 
-    EV_DETAIL << "(" << std::to_string(rtxCtn) << " attempt)" << endl;
+    sendMultiTargetDaos(aggregatedTargets, 0, 0);
+    aggregatedTargets.clear();
+}
+
+void Rpl::sendMultiTargetDaos(const std::vector<Ipv6Address> &targets, double delay, int retries) {
+    // a target may have been advertised more than once
+    std::vector<Ipv6Address> uniqueTargets(targets);
+    std::sort(uniqueTargets.begin(), uniqueTargets.end());
+    uniqueTargets.erase(std::unique(uniqueTargets.begin(), uniqueTargets.end()), uniqueTargets.end());
 
-    sendRplPacket(createDao(advDest), DAO, preferredParent->getSrcAddress(), daoDelay);
+    size_t maxTargets = daoAggregationMaxTargets > 0 ? daoAggregationMaxTargets : uniqueTargets.size();
+    for (size_t first = 0; first < uniqueTargets.size(); first += maxTargets) {
+        std::vector<Ipv6Address> daoTargets(uniqueTargets.begin() + first,
+                uniqueTargets.begin() + std::min(first + maxTargets, uniqueTargets.size()));
+        sendRplPacket(createDao(daoTargets), DAO, preferredParent->getSrcAddress(), delay);
+        if (retries > 0 && pendingDaoAcks.contains(daoTargets.front()))
+            pendingDaoAcks.setRetries(daoTargets.front(), retries);
+        numDaoForwarded++;
+        EV_DETAIL << "Forwarding DAO with " << daoTargets.size() << " targets to "
+                << preferredParent->getSrcAddress() << endl;
+    }
 }
 
 void Rpl::detachFromDodag() {
@@ -345,7 +465,7 @@ void Rpl::detachFromDodag() {
      * clearing dodagId, neighbor sets and setting it's rank to INFINITE_RANK [RFC6560, 8.2.2.1]
      */
     EV_DETAIL << "Candidate parent list empty, leaving DODAG" << endl;
-    backupParents.erase(backupParents.begin(), backupParents.end());
+    backupParents.clear();
     EV_DETAIL << "Backup parents list erased" << endl;
     /** Delete all routes associated with DAO destinations of the former DODAG */
     purgeDaoRoutes();
@@ -365,9 +485,8 @@ void Rpl::detachFromDodag() {
 void Rpl::purgeDaoRoutes() {
     std::list<Ipv6Route *> purgedRoutes;
     EV_DETAIL << "Purging DAO routes from the routing table: " << endl;
-    auto numRoutes = routingTable->getNumRoutes();
-    for (int i = 0; i < numRoutes; i++) {
-        auto ri = routingTable->getRoute(i);
+    for (const auto& entry : rplRoutes) {
+        auto ri = entry.second;
         auto routeData = dynamic_cast<RplRouteData *> (ri->getProtocolData());
         if (routeData && routeData->getDodagId() == dodagId && routeData->getInstanceId() == instanceId)
             purgedRoutes.push_front(ri);
@@ -551,29 +670,23 @@ void Rpl::sendRplPacket(const Ptr<RplPacket> &body, RplPacketCode code,
     if (code == DAO && ((dynamicPtrCast<Dao>) (body))->getDaoAckRequired()) {
         auto outgoingDao = (dynamicPtrCast<Dao>) (body);
         auto advertisedDest = outgoingDao->getReachableDest();
+        // a DAO_ACK for the reachable destination acknowledges all targets of a multi-target DAO
+        if (outgoingDao->getKnownTargetsArraySize() > 0) {
+            auto& pendingTargets = pendingAggregatedDaos[advertisedDest];
+            pendingTargets.clear();
+            for (size_t i = 0; i < outgoingDao->getKnownTargetsArraySize(); i++)
+                pendingTargets.push_back(outgoingDao->getKnownTargets(i));
+        }
         auto timeout = simTime() + SimTime(daoAckTimeout, SIMTIME_S) * uniform(1, 3); // TODO: Magic numbers
 
         EV_DETAIL << "Scheduling DAO_ACK timeout at " << timeout << " for advertised dest "
                 << advertisedDest << endl;
 
-        cMessage *daoTimeoutMsg = new cMessage("", DAO_ACK_TIMEOUT);
-        daoTimeoutMsg->setContextPointer(new Ipv6Address(advertisedDest));
-        EV_DETAIL << "Created DAO_ACK timeout msg with context pointer - "
-                << *((Ipv6Address *) daoTimeoutMsg->getContextPointer()) << endl;
+        // a pending entry keeps its retransmission count, only the timeout moves
+        pendingDaoAcks.arm(advertisedDest, timeout, simTime());
+        scheduleDaoAckTimeout();
 
-        auto daoAckEntry = pendingDaoAcks.find(advertisedDest);
-        if (daoAckEntry != pendingDaoAcks.end()) {
-            pendingDaoAcks[advertisedDest].first = daoTimeoutMsg;
-            EV_DETAIL << "Found existing entry in DAO_ACKs map for dest - " << advertisedDest
-                    << " updating timeout event ptr" << endl;
-        }
-        else
-            pendingDaoAcks[advertisedDest] = {daoTimeoutMsg, 0};
-
-        EV_DETAIL << "Pending DAO_ACKs:" << endl;
-        for (auto e : pendingDaoAcks)
-            EV_DETAIL << e.first << " (" << std::to_string(e.second.second) << " attempts), timeout msg ptr - " << e.second.first << endl;
-        scheduleAt(timeout, daoTimeoutMsg);
+        EV_DETAIL << "Pending DAO_ACKs:\n" << pendingDaoAcks.str() << endl;
     }
     sendPacket(pkt, delay);
 
@@ -603,141 +716,13 @@ const Ptr<Dio> Rpl::createDio()
     numDIOSent++; //CL 2021-08-05
     DIOsent.record(numDIOSent); //CL 2021-08-05
 
-    std::ofstream file;  //2022-05-12
-    file.open("St_DIOsent.txt", std::ios_base::app);
-    file << simTime() << " " << getParentModule()->getFullName() << endl ;
-    file.close();
+    TraceSink::line("St_DIOsent.txt") << simTime() << " " << getParentModule()->getFullName() << endl ;
 
     dio->setNumDIO(numDIOSent);
 
-    std::string OF = par("objectiveFunctionType").stdstringValue(); //CL 2021-11-02  0:ETX 1:HOP_COUNT 2:Energy
-    EV_INFO << "I am using OF:" << OF << endl;
-    if (OF == "ETX")
-        dio->setOcp(ETX);
-    else if (OF == "HOP_COUNT")
-        dio->setOcp(HOP_COUNT);
-    else if (OF == "HC_MOD")
-        dio->setOcp(HC_MOD);
-    else if (OF == "ML")
-        dio->setOcp(ML);
-    else if (OF=="RPL_ENH")
-        dio->setOcp(RPL_ENH);
-    else if (OF=="RPL_ENH2")
-        dio->setOcp(RPL_ENH2);
-    else
-        dio->setOcp(HOP_COUNT);
-
-    dio->setHC(hc);  //CL 2021-12-02
-    dio->setETX(etx); //CL 2021-12-02
-    //dio->setDROP(drop); //CL 2021-12-03  //it was using to test
-    //15-02-2022
-    //VERY IMPORTANT: the value that I put in my DIO is the value that I read from my MAC layer, but
-    //the value that I save to make decisions respect to my preferred parent is the one that I receive from
-    //other DIOs
-    auto mac = check_and_cast<Ieee802154Mac *>(host->getSubmodule("wlan",0)->getSubmodule("mac"));
-    //dio->setDropT(mac->nbDroppedFrames_copy);      //nbDroppedFrames in L2
-    dio->setDropB(mac->framedropbycongestion_copy);      //Frames drop by Backoff (congestion)
-    dio->setDropR(mac->framedropbyretry_limit_reached_copy);      //Frames drop by Retry (collisions or channel interferences)
-    dio->setMissACK(mac->nbMissedAcks_copy); //nbMissed ACKs
-    //dio->setTxF(mac->nbTxFrames_copy);         //nbTxFrames
-    //dio->setRxF(mac->nbRxFrames_copy);         //nbRxFrames
-    //dio->setBw(mac->channel_util);           //bandwidth, pending of implementing
-    dio->setDen(getneighbors());
-    dio->setQu(mac->qu);
-    //dio->setFps((mac->nbTxFrames_copy + mac->nbRxFrames_copy)/simTime()); //Frames per seconds 2022-05-05
-
-    //dio->setPath_cost(path_cost);
-
-    if (isRoot)
-        dio->setPath_cost(path_cost); //10/17/2022
-    else{
-        if(rank == 2)
-            dio->setPath_cost(objectiveFunction->Path_Cost_Calculator(preferredParent)); //Calculate ranking with respect to the root
-        else {
-            //getting the path_cost through my best forwarding candidate at the time of sending a dio
-            if (simTime() < 100)
-                dio->setPath_cost(0);
-                //dio->setPath_cost(hc + 1);
-            else
-                dio->setPath_cost(objectiveFunction->GetBestCandidatePATHCOST(candidateParents));
-        }
-    }
-
+    dio->setOcp(objectiveFunction->getOcp());
 
-    dio->setSnr(snr); //For SNR the analysis is different. The DIO carries any (in this case zero) value of SNR, once
-                      // receiving the DIO the receiver update the SNR at the receiver.
-
-    dio->setLast_update(simTime()) ; //11/03/2022 ... I want to know how out of date is my DIO information later
-
-    auto radio = check_and_cast<Radio *>(host->getSubmodule("wlan",0)->getSubmodule("radio")); //CL: 2022-09-13
-    //EV_INFO << " SNR at receiving this sender: " << radio->snr_L1 << endl;
-    dio->setRx_un_suc(radio->rx_unsuccessful);  //value read from my radio layer
-    double fail_retry_current_value;
-    double fail_cong_current_value;
-    double rx_frame_rate;
-    double current_rx_frame_rate = mac->nbRxFrames_copy;
-
-    if (simTime() - mac->last_reading > 300){
-        double beta = 0.9;
-        dio->setRx_suc_rate(beta*(radio->rx_successful_rate) + (1-beta)*radio->rx_successful_rate_copy);
-        if (mac->nbTxFrames_copy + mac->txAttempts_copy == 0)
-            fail_retry_current_value = 0;
-        else
-            fail_retry_current_value = (mac->framedropbyretry_limit_reached + mac->txAttempts_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy);
-
-        dio->setTxF(beta*fail_retry_current_value + (1-beta)*mac->fail_rate_retry);
-
-        if (mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy == 0)
-            fail_cong_current_value = 0;
-        else
-            fail_cong_current_value = (mac->framedropbycongestion + mac->txAttempts_copy + mac->NB_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy);
-
-        dio->setRxF(beta*fail_cong_current_value + (1-beta)*mac->fail_rate_cong);
-
-        rx_frame_rate = beta*current_rx_frame_rate + (1-beta)*mac->rx_frames_rate ;  //check this!!!!!!!!
-
-    } else {
-        double beta = 0.6;
-        dio->setRx_suc_rate(beta*(radio->rx_successful_rate) + (1-beta)*radio->rx_successful_rate_copy);
-        EV_INFO << "rx_successful_rate: " << radio->rx_successful_rate   << endl;
-        EV_INFO << "rx_successful_rate_copy: " << radio->rx_successful_rate_copy  << endl;
-        if (mac->nbTxFrames_copy + mac->txAttempts_copy == 0)
-            fail_retry_current_value = 0;
-        else
-            fail_retry_current_value = (mac->framedropbyretry_limit_reached + mac->txAttempts_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy);
-
-        dio->setTxF(beta*fail_retry_current_value + (1-beta)*mac->fail_rate_retry);
-
-        if (mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy == 0)
-            fail_cong_current_value = 0;
-        else
-            fail_cong_current_value = (mac->framedropbycongestion + mac->txAttempts_copy + mac->NB_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy);
-
-        dio->setRxF(beta*fail_cong_current_value + (1-beta)*mac->fail_rate_cong);
-
-        rx_frame_rate = beta*current_rx_frame_rate + (1-beta)*mac->rx_frames_rate ;  //check this!!!!!!!!
-    }
-
-    dio->setFps (rx_frame_rate); //2022-11-06
-
-    //To do the same with the ch utilization
-            double current_ch_util;
-            if (mac->busy + mac->idle == 0)
-                current_ch_util = 0.5;
-            else
-                current_ch_util = mac->busy/(mac->busy + mac->idle);
-
-            double my_ch_util = 0;
-
-            if (simTime() - mac->last_ch_uti_reset > 300){
-                double beta = 0.9;
-                my_ch_util = beta*current_ch_util + (1-beta)*mac->channel_util ;
-            } else {
-                double beta = 0.6;
-                my_ch_util = beta*current_ch_util + (1-beta)*mac->channel_util ;
-            }
-
-            dio->setBw(my_ch_util);
+    setDioMetrics(dio);
 
     return dio;
 }
@@ -766,143 +751,68 @@ const Ptr<Dio> Rpl::createDio_Unique()
     numDIOSent++; //CL 2021-08-05
     DIOsent.record(numDIOSent); //CL 2021-08-05
 
-    std::ofstream file;  //2022-05-12
-    file.open("St_DIOsent.txt", std::ios_base::app);
-    file << simTime() << " " << getParentModule()->getFullName() << endl ;
-    file.close();
+    TraceSink::line("St_DIOsent.txt") << simTime() << " " << getParentModule()->getFullName() << endl ;
 
     dio->setNumDIO(numDIOSent);
 
-    std::string OF = par("objectiveFunctionType").stdstringValue(); //CL 2021-11-02  0:ETX 1:HOP_COUNT 2:Energy
-    EV_INFO << "I am using OF:" << OF << endl;
-    if (OF == "ETX")
-        dio->setOcp(ETX);
-    else if (OF == "HOP_COUNT")
-        dio->setOcp(HOP_COUNT);
-    else if (OF == "HC_MOD")
-        dio->setOcp(HC_MOD);
-    else if (OF == "ML")
-        dio->setOcp(ML);
-    else if (OF=="RPL_ENH")
-        dio->setOcp(RPL_ENH);
-    else if (OF=="RPL_ENH2")
-        dio->setOcp(RPL_ENH2);
-    else
-        dio->setOcp(HOP_COUNT);
-
-    dio->setHC(hc);  //CL 2021-12-02
-    dio->setETX(etx); //CL 2021-12-02
-    //dio->setDROP(drop); //CL 2021-12-03  //it was using to test
-    //15-02-2022
-    //VERY IMPORTANT: the value that I put in my DIO is the value that I read from my MAC layer, but
-    //the value that I save to make decisions respect to my preferred parent is the one that I receive from
-    //other DIOs
-    auto mac = check_and_cast<Ieee802154Mac *>(host->getSubmodule("wlan",0)->getSubmodule("mac"));
-    //dio->setDropT(mac->nbDroppedFrames_copy);      //nbDroppedFrames in L2
-    dio->setDropB(mac->framedropbycongestion_copy);      //Frames drop by Backoff (congestion)
-    dio->setDropR(mac->framedropbyretry_limit_reached_copy);      //Frames drop by Retry (collisions or channel interferences)
-    dio->setMissACK(mac->nbMissedAcks_copy); //nbMissed ACKs
-    //dio->setTxF(mac->nbTxFrames_copy);         //nbTxFrames
-    //dio->setRxF(mac->nbRxFrames_copy);         //nbRxFrames
-    //dio->setBw(mac->channel_util);           //bandwidth, pending of implementing
-    dio->setDen(getneighbors());
-    dio->setQu(mac->qu);
-    //dio->setFps((mac->nbTxFrames_copy + mac->nbRxFrames_copy)/simTime()); //Frames per seconds 2022-05-05
-
-    //dio->setPath_cost(path_cost);
-
-    if (isRoot)
-        dio->setPath_cost(path_cost); //10/17/2022
-    else{
-        if(rank == 2)
-            dio->setPath_cost(objectiveFunction->Path_Cost_Calculator(preferredParent)); //Calculate ranking with respect to the root
-        else {
-            //getting the path_cost through my best forwarding candidate at the time of sending a dio
-            if (simTime() < 100)
-                dio->setPath_cost(0);
-                //dio->setPath_cost(hc + 1);
-            else
-                dio->setPath_cost(objectiveFunction->GetBestCandidatePATHCOST(candidateParents));
-        }
-    }
+    dio->setOcp(objectiveFunction->getOcp());
 
+    setDioMetrics(dio);
 
-    dio->setSnr(snr); //For SNR the analysis is different. The DIO carries any (in this case zero) value of SNR, once
-                      // receiving the DIO the receiver update the SNR at the receiver.
+    return dio;
+}
 
+void Rpl::setDioMetrics(const Ptr<Dio>& dio)
+{
+    dio->setHC(hc);  //CL 2021-12-02
     dio->setLast_update(simTime()) ; //11/03/2022 ... I want to know how out of date is my DIO information later
 
-    auto radio = check_and_cast<Radio *>(host->getSubmodule("wlan",0)->getSubmodule("radio")); //CL: 2022-09-13
-    //EV_INFO << " SNR at receiving this sender: " << radio->snr_L1 << endl;
-    dio->setRx_un_suc(radio->rx_unsuccessful);  //value read from my radio layer
-    double fail_retry_current_value;
-    double fail_cong_current_value;
-    double rx_frame_rate;
-    double current_rx_frame_rate = mac->nbRxFrames_copy;
-
-    if (simTime() - mac->last_reading > 300){
-        double beta = 0.9;
-        dio->setRx_suc_rate(beta*(radio->rx_successful_rate) + (1-beta)*radio->rx_successful_rate_copy);
-        if (mac->nbTxFrames_copy + mac->txAttempts_copy == 0)
-            fail_retry_current_value = 0;
-        else
-            fail_retry_current_value = (mac->framedropbyretry_limit_reached + mac->txAttempts_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy);
+    // metric groups the objective function doesn't read keep their defaults
+    if (metrics & RPL_METRIC_ETX)
+        dio->setETX(etx); //CL 2021-12-02
 
-        dio->setTxF(beta*fail_retry_current_value + (1-beta)*mac->fail_rate_retry);
-
-        if (mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy == 0)
-            fail_cong_current_value = 0;
-        else
-            fail_cong_current_value = (mac->framedropbycongestion + mac->txAttempts_copy + mac->NB_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy);
-
-        dio->setRxF(beta*fail_cong_current_value + (1-beta)*mac->fail_rate_cong);
-
-        rx_frame_rate = beta*current_rx_frame_rate + (1-beta)*mac->rx_frames_rate ;  //check this!!!!!!!!
-
-    } else {
-        double beta = 0.6;
-        dio->setRx_suc_rate(beta*(radio->rx_successful_rate) + (1-beta)*radio->rx_successful_rate_copy);
-        EV_INFO << "rx_successful_rate: " << radio->rx_successful_rate   << endl;
-        EV_INFO << "rx_successful_rate_copy: " << radio->rx_successful_rate_copy  << endl;
-        if (mac->nbTxFrames_copy + mac->txAttempts_copy == 0)
-            fail_retry_current_value = 0;
-        else
-            fail_retry_current_value = (mac->framedropbyretry_limit_reached + mac->txAttempts_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy);
-
-        dio->setTxF(beta*fail_retry_current_value + (1-beta)*mac->fail_rate_retry);
-
-        if (mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy == 0)
-            fail_cong_current_value = 0;
-        else
-            fail_cong_current_value = (mac->framedropbycongestion + mac->txAttempts_copy + mac->NB_copy)/(mac->nbTxFrames_copy + mac->txAttempts_copy + mac->NB_copy);
-
-        dio->setRxF(beta*fail_cong_current_value + (1-beta)*mac->fail_rate_cong);
-
-        rx_frame_rate = beta*current_rx_frame_rate + (1-beta)*mac->rx_frames_rate ;  //check this!!!!!!!!
-    }
-
-    dio->setFps (rx_frame_rate); //2022-11-06
-
-    //To do the same with the ch utilization
-            double current_ch_util;
-            if (mac->busy + mac->idle == 0)
-                current_ch_util = 0.5;
-            else
-                current_ch_util = mac->busy/(mac->busy + mac->idle);
-
-            double my_ch_util = 0;
-
-            if (simTime() - mac->last_ch_uti_reset > 300){
-                double beta = 0.9;
-                my_ch_util = beta*current_ch_util + (1-beta)*mac->channel_util ;
-            } else {
-                double beta = 0.6;
-                my_ch_util = beta*current_ch_util + (1-beta)*mac->channel_util ;
+    //VERY IMPORTANT: the value that I put in my DIO is the value that I read from my MAC layer, but
+    //the value that I save to make decisions respect to my preferred parent is the one that I receive from
+    //other DIOs
+    if (metrics & RPL_METRIC_LINK_QUALITY) {
+        dio->setDropB(mac->framedropbycongestion_copy);      //Frames drop by Backoff (congestion)
+        dio->setDropR(mac->framedropbyretry_limit_reached_copy);      //Frames drop by Retry (collisions or channel interferences)
+        dio->setMissACK(mac->nbMissedAcks_copy); //nbMissed ACKs
+        dio->setDen(getneighbors());
+        dio->setQu(mac->getLinkMetrics().getQueueUtilization());
+
+        //Fail rates, rx frame rate and channel utilization come from the MAC's estimators, which are kept up to date
+        //on every counter change
+        const LinkMetrics& linkMetrics = mac->getLinkMetrics();
+        dio->setTxF(linkMetrics.getFailRateRetry());
+        dio->setRxF(linkMetrics.getFailRateCong());
+        dio->setFps(linkMetrics.getRxFrameRate()); //2022-11-06
+        dio->setBw(linkMetrics.getChannelUtilization(0.5));
+    }
+
+    if (metrics & RPL_METRIC_RADIO) {
+        dio->setSnr(snr); //For SNR the analysis is different. The DIO carries any (in this case zero) value of SNR, once
+                          // receiving the DIO the receiver update the SNR at the receiver.
+        dio->setRx_un_suc(radio->rx_unsuccessful);  //value read from my radio layer
+        // the rx success rate of the radio is weighted like the MAC's estimators
+        dio->setRx_suc_rate(mac->getLinkMetrics().blendWithPeriod(radio->rx_successful_rate, radio->rx_successful_rate_copy));
+    }
+
+    if (metrics & RPL_METRIC_PATH_COST) {
+        if (isRoot)
+            dio->setPath_cost(path_cost); //10/17/2022
+        else{
+            if(rank == 2)
+                dio->setPath_cost(objectiveFunction->Path_Cost_Calculator(preferredParent.get())); //Calculate ranking with respect to the root
+            else {
+                //getting the path_cost through my best forwarding candidate at the time of sending a dio
+                if (simTime() < 100)
+                    dio->setPath_cost(0);
+                else
+                    dio->setPath_cost(objectiveFunction->GetBestCandidatePATHCOST(candidateParents));
             }
-
-            dio->setBw(my_ch_util);
-
-    return dio;
+        }
+    }
 }
 
 // @p channelOffset - cross-layer specific parameter, useless in default RPL
@@ -926,6 +836,18 @@ const Ptr<Dao> Rpl::createDao(const Ipv6Address &reachableDest, uint8_t channelO
     return dao;
 }
 
+const Ptr<Dao> Rpl::createDao(const std::vector<Ipv6Address> &targets)
+{
+    auto dao = createDao(targets.front());
+    if (targets.size() > 1) {
+        for (const auto& target : targets)
+            dao->insertKnownTargets(target);
+        // one more RPL Target option (4 + 16 octets) per additional target [RFC6550, 6.7.7]
+        dao->setChunkLength(dao->getChunkLength() + B(20 * (targets.size() - 1)));
+    }
+    return dao;
+}
+
 const Ptr<Dao> Rpl::createDao(const Ipv6Address &reachableDest, bool ackRequired)
 {
     EV_INFO << "I'm using createDao(const Ipv6Address &reachableDest, bool ackRequired)" << endl;
@@ -958,59 +880,52 @@ bool Rpl::isUdpSink() {
     return false;
 }
 
-void Rpl::processDio(const Ptr<const Dio>& dio1)
+void Rpl::processDio(const Ptr<const Dio>& dio)
 //void Rpl::processDio(Ptr<Dio>& dio) //CL: I removed the const to be able to add a new field into the DIO
 {
     if (isRoot){
-        countNeighbours(dio1);
+        countNeighbours(dio);
         return;
     }
 
-    EV_DETAIL << "Processing DIO from: " << dio1->getSrcAddress() << endl; //CL
-    EV_DETAIL << "DIO sender Id: " << dio1->getNodeId() << endl;
-    EV_DETAIL << "Num of DIO from this sender: " << dio1->getNumDIO() << endl; //CL:to check the parameter value
+    EV_DETAIL << "Processing DIO from: " << dio->getSrcAddress() << endl; //CL
+    EV_DETAIL << "DIO sender Id: " << dio->getNodeId() << endl;
+    EV_DETAIL << "Num of DIO from this sender: " << dio->getNumDIO() << endl; //CL:to check the parameter value
     //updateCounterCache(dio); //CL
-    EV_INFO << "HC value of this sender: " << dio1->getHC() << endl;   //CL: 2021-12-02
-    EV_INFO << "ETX value of this sender: " <<dio1->getETX() << endl;
+    EV_INFO << "HC value of this sender: " << dio->getHC() << endl;   //CL: 2021-12-02
+    EV_INFO << "ETX value of this sender: " <<dio->getETX() << endl;
     //EV_INFO << "frame dropped by this sender: " <<dio->getDROP() << endl; //CL: 2021-12-02
     //EV_INFO << "total frames dropped by this sender: " <<dio->getDropT() << endl; //CL: 2022-02-16
-    EV_INFO << "frame dropped(backoff) by this sender: " <<dio1->getDropB() << endl; //CL: 2022-02-16
-    EV_INFO << "frame dropped(retry) by this sender: " <<dio1->getDropR() << endl; //CL: 2022-02-16
-    EV_INFO << "total ACKs missed by this sender: " <<dio1->getMissACK() << endl; //CL: 2022-02-16
-    EV_INFO << "total frames transmitted by this sender: " <<dio1->getTxF() << endl; //CL: 2022-02-16
-    EV_INFO << "total frames received by this sender: " <<dio1->getRxF() << endl; //CL: 2022-02-16
-    EV_INFO << "frame per seconds of this sender: " << dio1->getFps() << endl; //2022-05-05
-    EV_INFO << "channel utilization of this sender: " << dio1->getBw() << endl;
-    EV_INFO << "SNR that comes with this sender: " << dio1->getSnr() << endl; //2022-09-14
-    EV_INFO << "Unsuccessful packets that this sender has received: " << dio1->getRx_un_suc() << endl; //2022-09-29
-    EV_INFO << "Packet successful rate of this sender: " << dio1->getRx_suc_rate() << endl; //2022-09-29
-    EV_INFO << "Path cost that is advertised by this sender: " << dio1->getPath_cost() << endl; //2022-10-17
+    EV_INFO << "frame dropped(backoff) by this sender: " <<dio->getDropB() << endl; //CL: 2022-02-16
+    EV_INFO << "frame dropped(retry) by this sender: " <<dio->getDropR() << endl; //CL: 2022-02-16
+    EV_INFO << "total ACKs missed by this sender: " <<dio->getMissACK() << endl; //CL: 2022-02-16
+    EV_INFO << "total frames transmitted by this sender: " <<dio->getTxF() << endl; //CL: 2022-02-16
+    EV_INFO << "total frames received by this sender: " <<dio->getRxF() << endl; //CL: 2022-02-16
+    EV_INFO << "frame per seconds of this sender: " << dio->getFps() << endl; //2022-05-05
+    EV_INFO << "channel utilization of this sender: " << dio->getBw() << endl;
+    EV_INFO << "SNR that comes with this sender: " << dio->getSnr() << endl; //2022-09-14
+    EV_INFO << "Unsuccessful packets that this sender has received: " << dio->getRx_un_suc() << endl; //2022-09-29
+    EV_INFO << "Packet successful rate of this sender: " << dio->getRx_suc_rate() << endl; //2022-09-29
+    EV_INFO << "Path cost that is advertised by this sender: " << dio->getPath_cost() << endl; //2022-10-17
 
     //Here I have to get the value of the SNR of the dio I just received. 2022-09-12
     //auto radio = check_and_cast<Radio *>(host->getSubmodule("wlan",0)->getSubmodule("radio")); //CL: 2022-09-13
     //EV_INFO << " SNR at receiving this sender: " << radio->snr_L1 << endl;
     //Here, I changed this part 10/30/2022, because I want to get the average SNR of this sender.
-    macModule = getParentModule()->getSubmodule("wlan",0)->getSubmodule("mac");
-    mac = check_and_cast<Ieee802154Mac *>(macModule);
     //uint64_t nodeId = dio->getNodeId();
-    double ave_snr = mac->getSNRave(dio1->getNodeId()); //I am going to call a method defined in mac layer to get the ave SNR.
-    EV_INFO << " AVE SNR at receiving this sender: " << ave_snr << endl;
-
-    //I should add to this DIO a new field to put in the SNR value:
-    Dio *dio_copy;
-    dio_copy = dio1->dup();
-    EV_INFO << "SNR from dio_copy: " << dio_copy->getSnr() << endl ;
-    //dio_copy->setSnr(radio->snr_L1);
-    dio_copy->setSnr(ave_snr);
-    EV_INFO << "SNR from dio_copy after modifying SNR: " << dio_copy->getSnr() << endl ;
-    auto dio = makeShared<Dio>();
-    dio = dio_copy->dup();
-    EV_INFO << "AVE SNR after changing the value in the original DIO: " << dio->getSnr() << endl ;
+    //The received DIO is shared with the packet and stays untouched, the values measured on
+    //reception (average SNR of this sender, rx time) go along in rxInfo instead of a patched copy
+    DioRxInfo rxInfo;
+    if (metrics & RPL_METRIC_RADIO) {
+        rxInfo.snr = mac->getSNRave(dio->getNodeId()); //I am going to call a method defined in mac layer to get the ave SNR.
+        EV_INFO << " AVE SNR at receiving this sender: " << rxInfo.snr << endl;
+    }
+    rxInfo.rxTime = simTime();
 
     //method to count DIOs from different nodes to know how many neighbours a node has
     countNeighbours(dio);
 
-    emit(dioReceivedSignal, dio->dup());
+    emit(dioReceivedSignal, dio.get());
 
     // If node's not a part of any DODAG, join the first one advertised
     if (dodagId == Ipv6Address::UNSPECIFIED_ADDRESS && dio->getRank() != INF_RANK)
@@ -1020,13 +935,13 @@ void Rpl::processDio(const Ptr<const Dio>& dio1)
         instanceId = dio->getInstanceId();
         storing = dio->getStoring();
         dtsn = dio->getDtsn();
-        lastTarget = new Ipv6Address(getSelfAddress());
+        lastTarget = getSelfAddress();
         selfAddr = getSelfAddress();
         dodagColor = dio->getColor();
         EV_DETAIL << "Joined DODAG with id - " << dodagId << endl;
         purgeRoutingTable();
-        updateMetrics_fromDIO(dio);  //CL 2021-12-02
-        preferredParent = dio->dup(); // 2022-04-29: if node is not part of the DODAG, the sender of the first DIO is
+        updateMetrics_fromDIO(dio, rxInfo);  //CL 2021-12-02
+        setPreferredParent(RplNeighbor(*dio, rxInfo, metrics)); // 2022-04-29: if node is not part of the DODAG, the sender of the first DIO is
                                       // is going to be the preferred parent. Also to avoid the error regarding to
                                       // updatePreferredParent method when the preferred parent is empty at the
                                       // begining
@@ -1071,12 +986,10 @@ void Rpl::processDio(const Ptr<const Dio>& dio1)
        //PyRun_SimpleString("print('Hello World from Embedded Python!!!')");
     //Py_Finalize();
 
-    //connecting(); //2022-07-06: This method was created for testing socket programing only
-
 //1. DIO sender is in the parent list?
     dio_received = dio_received + 1 ; //to count DIOs received
     EV_INFO << "Checking if DIO sender is in the parent list: " << endl;
-    if (candidateParents.find(dioSender) != candidateParents.end()){
+    if (candidateParents.contains(dioSender)){
         //EV_DETAIL << "Candidate parent entry updated - " << dioSender << endl; //verify how the entry is updated
         EV_INFO << "DIO sender is in the parent list: " << endl;
         temp_rank = objectiveFunction->calcTemp_Rank(dio);
@@ -1090,19 +1003,19 @@ void Rpl::processDio(const Ptr<const Dio>& dio1)
                 EV_INFO << "My rank respect to my Preferred parent has changed (it is worse now)" << endl;  //CL 2022-02-02
                 //This could happened due to a change in my parent rank, a change in the link conditions or both at the same time
                 c = c + 1;  //CL 2022-01-31
-                updateNeighbour(dio); // CL 2022-02-02
+                updateNeighbour(dio, rxInfo); // CL 2022-02-02
                 updatePreferredParent();
                 //updateMetrics   I should pass to this function the current preferred parent
-                updateMetrics_fromPrefParent(preferredParent);
+                updateMetrics_fromPrefParent(preferredParent.get());
             }else if (temp_rank == rank){
                 //EV_INFO << "Preferred parent advertising the same rank, discarding DIO" << endl;
                 EV_INFO << "My rank respect to my Preferred parent has not changed" << endl;  //CL 2022-02-02
                 c1 = c1 + 1;  //CL 2022-01-31
                 //2022-03-08: I need to add this b/c the DIO is carried dynamic metrics.
-                updateNeighbour(dio);
-                preferredParent = dio->dup(); //Just copy the DIO
+                updateNeighbour(dio, rxInfo);
+                setPreferredParent(RplNeighbor(*dio, rxInfo, metrics)); //Just copy the DIO
                 //updateMetrics_fromDIO(dio); //this works hear, and also in the next else, update directly from DIO b/c is my pref parent
-                updateMetrics_fromPrefParent(preferredParent);
+                updateMetrics_fromPrefParent(preferredParent.get());
                 updatePreferredParent(); //2022-10-17: now the pref parent is related to the path cost, so even if the
                 //rank did not change, the path cost could have deteriorated.
                 //EV_INFO << "txF of my pref parent: " << preferredParent->getTxF() << endl;
@@ -1110,10 +1023,10 @@ void Rpl::processDio(const Ptr<const Dio>& dio1)
             }else{
                 //EV_INFO << "Preferred parent advertising a better rank, forward this DIO" << endl;
                 EV_INFO << "My rank respect to my Preferred parent has changed (it is better now)" << endl;  //CL 2022-02-02
-                updateNeighbour(dio); // CL 2022-02-02
-                preferredParent = dio->dup(); //Just copy the DIO
+                updateNeighbour(dio, rxInfo); // CL 2022-02-02
+                setPreferredParent(RplNeighbor(*dio, rxInfo, metrics)); //Just copy the DIO
                 //updateMetrics
-                updateMetrics_fromPrefParent(preferredParent);
+                updateMetrics_fromPrefParent(preferredParent.get());
                 c2 = c2 + 1;  //CL 2022-01-31
             }
         }else{
@@ -1122,28 +1035,27 @@ void Rpl::processDio(const Ptr<const Dio>& dio1)
                 //EV_INFO << "A node in the parent list advertising a worse rank, just update the parent list" << endl;
                 EV_INFO << "My rank respect to a node in the parent list has changed (it is worse)" << endl;  //CL 2022-02-02
                 c3 = c3 + 1;  //CL 2022-01-31
-                updateNeighbour(dio); // CL 2022-02-02
+                updateNeighbour(dio, rxInfo); // CL 2022-02-02
             }else if (temp_rank == rank ){
                 //EV_INFO << "A node in the parent list advertising a rank equal to it was, nothing to do" << endl;
                 EV_INFO << "My rank respect to a node in the parent list is the same as it was, nothing to do" << endl;  //CL 2022-02-02
                 //But update info of this node anyway:
-                updateNeighbour(dio);
+                updateNeighbour(dio, rxInfo);
                 c4 = c4 + 1;  //CL 2022-01-31
                 //But for the new OF this node can be the new father, I need to check it
                 //I should check which OF I am using
-                std::string OF = par("objectiveFunctionType").stdstringValue(); //CL 2021-11-02  0:ETX 1:HOP_COUNT 2:Energy
-                if (OF == "HC_MOD" or OF == "RPL_ENH"){
+                if (objectiveFunction->reevaluatesOnEqualRank()){
                     updatePreferredParent();  //2022-05-04
-                    updateMetrics_fromPrefParent(preferredParent); //2022-05-04
+                    updateMetrics_fromPrefParent(preferredParent.get()); //2022-05-04
                     return;
                 }
                 return;
             }else{
                 //EV_INFO << "A node in the parent list advertising a better rank, check if it can be the new preferred parent" << endl;
                 EV_INFO << "My rank respect to a node in the parent list has changed (it is better)" << endl;  //CL 2022-02-02
-                updateNeighbour(dio); // CL 2022-02-02
+                updateNeighbour(dio, rxInfo); // CL 2022-02-02
                 updatePreferredParent();
-                updateMetrics_fromPrefParent(preferredParent); //here i need that works well
+                updateMetrics_fromPrefParent(preferredParent.get()); //here i need that works well
                 c5 = c5 + 1;  //CL 2022-01-31
             }
         }
@@ -1162,7 +1074,7 @@ void Rpl::processDio(const Ptr<const Dio>& dio1)
         }else{
             EV_INFO << "I'll add a new neighbor as a candidate parent" << endl ;
             c6 = c6 + 1 ;
-            addNeighbour(dio);  //When I do this I have to save all the metrics this sender is advertising
+            addNeighbour(dio, rxInfo);  //When I do this I have to save all the metrics this sender is advertising
         }
     }
 //    if (dio->getRank() > rank) {   //for ETX OF I have to jump this or do this: >rank-1 & first time received otherwise no bc could be the pref parent or another node already in that worst
@@ -1176,9 +1088,16 @@ void Rpl::processDio(const Ptr<const Dio>& dio1)
 }
 
 void Rpl::purgeRoutingTable() {
-    auto numRoutes = routingTable->getNumRoutes();
-    for (auto i = 0; i < numRoutes; i++)
-        routingTable->deleteRoute(routingTable->getRoute(i));
+    // only the routes RPL installed (rplRoutes) are purged, routes added by the interface
+    // configuration or other protocols are kept; the old loop meant to delete every route
+    // but skipped every second one while the indices shifted
+    // deleting emits routeDeletedSignal, which erases the index entry
+    std::vector<Ipv6Route *> purgedRoutes;
+    purgedRoutes.reserve(rplRoutes.size());
+    for (const auto& entry : rplRoutes)
+        purgedRoutes.push_back(entry.second);
+    for (auto route : purgedRoutes)
+        routingTable->deleteRoute(route);
 }
 
 bool Rpl::checkPoisonedParent(const Ptr<const Dio>& dio) {
@@ -1191,7 +1110,7 @@ void Rpl::processDao(const Ptr<const Dao>& dao) {
         return;
     }
 
-    emit(daoReceivedSignal, dao->dup());
+    emit(daoReceivedSignal, dao.get());
     auto daoSender = dao->getSrcAddress();
     auto advertisedDest = dao->getReachableDest();
     EV_DETAIL << "Processing DAO with seq num " << std::to_string(dao->getSeqNum()) << " from "
@@ -1203,20 +1122,33 @@ void Rpl::processDao(const Ptr<const Dao>& dao) {
                 << " acknowledging advertised dest - " << advertisedDest << endl;
     }
 
+    // a multi-target DAO lists all of its targets, the reachable destination among them
+    std::vector<Ipv6Address> targets;
+    for (size_t i = 0; i < dao->getKnownTargetsArraySize(); i++)
+        targets.push_back(dao->getKnownTargets(i));
+    if (targets.empty())
+        targets.push_back(advertisedDest);
+
     /**
      * If a node is root or operates in storing mode
      * update routing table with destinations from DAO [RFC6560, 3.3].
-     * TODO: Implement DAO aggregation!
+     * Only newly learned targets are propagated further.
      */
     if (storing || isRoot) {
-        if (!checkDestKnown(daoSender, advertisedDest)) {
-            updateRoutingTable(daoSender, advertisedDest, prepRouteData(dao.get()));
-
-            EV_DETAIL << "Destination learned from DAO - " << advertisedDest
-                    << " reachable via " << daoSender << endl;
+        std::vector<Ipv6Address> learnedTargets;
+        for (const auto& target : targets) {
+            if (!checkDestKnown(daoSender, target)) {
+                // every route owns its route data
+                updateRoutingTable(daoSender, target, prepRouteData(dao.get()));
+                learnedTargets.push_back(target);
+
+                EV_DETAIL << "Destination learned from DAO - " << target
+                        << " reachable via " << daoSender << endl;
+            }
         }
-        else
+        if (learnedTargets.empty())
             return;
+        targets = learnedTargets;
     }
     /**
      * Forward DAO 'upwards' via preferred parent advertising destination to the root [RFC6560, 6.4]
@@ -1224,9 +1156,13 @@ void Rpl::processDao(const Ptr<const Dao>& dao) {
     if (!isRoot && preferredParent) {
         if (!storing)
             sendRplPacket(createDao(advertisedDest), DAO,
-                preferredParent->getSrcAddress(), daoDelay * uniform(1, 2), *lastTarget, *lastTransit);
+                preferredParent->getSrcAddress(), daoDelay * uniform(1, 2), lastTarget, lastTransit);
+        else if (daoAggregationWindow > 0) {
+            aggregateDaoTargets(targets);
+            return;
+        }
         else
-            sendRplPacket(createDao(advertisedDest), DAO,
+            sendRplPacket(createDao(targets), DAO,
                 preferredParent->getSrcAddress(), daoDelay * uniform(1, 2));
 
         numDaoForwarded++;
@@ -1238,8 +1174,8 @@ void Rpl::processDao(const Ptr<const Dao>& dao) {
 std::vector<Ipv6Address> Rpl::getNearestChildren() {
     auto prefParentAddr = preferredParent ? preferredParent->getSrcAddress() : Ipv6Address::UNSPECIFIED_ADDRESS;
     std::vector<Ipv6Address> neighbrs = {};
-    for (auto i = 0; i < routingTable->getNumRoutes(); i++) {
-        auto rt = routingTable->getRoute(i);
+    for (const auto& entry : rplRoutes) {
+        auto rt = entry.second;
         auto dest = rt->getDestPrefix();
         auto nextHop = rt->getNextHop();
 
@@ -1264,11 +1200,7 @@ void Rpl::processDaoAck(const Ptr<const Dao>& daoAck) {
 
     clearDaoAckTimer(advDest);
 
-    EV_DETAIL << "Cancelled timeout event and erased entry in the pendingDaoAcks, remaining: " << endl;
-
-    for (auto e : pendingDaoAcks)
-        EV_DETAIL << e.first << " rtxs: " << std::to_string(e.second.second)
-            << ", msg ptr - " << e.second.first << endl;
+    EV_DETAIL << "Erased entry in the pendingDaoAcks, remaining: \n" << pendingDaoAcks.str() << endl;
 
 }
 
@@ -1300,7 +1232,7 @@ void Rpl::updatePreferredParent()
     //2022-04-11: To be used later to see if the rank changed
     double current_rank = rank;
 
-    Dio *newPrefParent;
+    const RplNeighbor *newPrefParent;
     EV_DETAIL << "Choosing preferred parent from "
             << boolStr(candidateParents.empty() && par("useBackupAsPreferred").boolValue(),
                     "backup", "candidate") << " parent set" << endl;
@@ -1309,7 +1241,7 @@ void Rpl::updatePreferredParent()
      */
     if (candidateParents.empty())
         if (par("useBackupAsPreferred").boolValue())
-            newPrefParent = objectiveFunction->getPreferredParent(backupParents, preferredParent); //back to this on 22-04-29
+            newPrefParent = objectiveFunction->getPreferredParent(backupParents, preferredParent.get()); //back to this on 22-04-29
             //newPrefParent = objectiveFunction->getPreferredParent(backupParents, preferredParent); //2022-03-08
         else {
             detachFromDodag();
@@ -1317,7 +1249,7 @@ void Rpl::updatePreferredParent()
         }
     else
         //newPrefParent = objectiveFunction->getPreferredParent(candidateParents);
-        newPrefParent = objectiveFunction->getPreferredParent(candidateParents, preferredParent); //2022-03-08...2022-04-29
+        newPrefParent = objectiveFunction->getPreferredParent(candidateParents, preferredParent.get()); //2022-03-08...2022-04-29
 
     auto newPrefParentAddr = newPrefParent->getSrcAddress();
     /**
@@ -1327,9 +1259,7 @@ void Rpl::updatePreferredParent()
     if (!(checkPrefParentChanged(newPrefParentAddr,previous_PrefParentAddr))) {  //2022-03-08
 
         //CL: if it is here is because the preferred parent changed otherwise it was only updated
-        std::ofstream file;  // CL 2022-02-02
-        file.open("St_PrefParentChanges.txt", std::ios_base::app);
-        file << simTime() <<" " << getParentModule()->getFullName() << "The preferred parent is another node" << endl;
+        TraceSink::line("St_PrefParentChanges.txt") << simTime() <<" " << getParentModule()->getFullName() << "The preferred parent is another node" << endl;
         //
 
         auto newPrefParentDodagId = newPrefParent->getDodagId();
@@ -1348,9 +1278,10 @@ void Rpl::updatePreferredParent()
         if (newPrefParentAddr != dodagId)
             updateRoutingTable(newPrefParentAddr, newPrefParentAddr, nullptr, false);
 
-        lastTransit = new Ipv6Address(newPrefParentAddr);
+        lastTransit = newPrefParentAddr;
         EV_DETAIL << "Updated preferred parent to - " << newPrefParentAddr << endl;
         numParentUpdates++;
+        emit(parentChangedSignal, numParentUpdates);
         /**
          * Reset trickle timer due to inconsistency (preferred parent changed) detected, thus
          * maintaining higher topology reactivity and convergence rate [RFC 6550, 8.3]
@@ -1363,26 +1294,22 @@ void Rpl::updatePreferredParent()
          * to advertise the change. For RPL_ENH, if the node does not change the rank value and just changes to a pref parent with the same ranking, but better path_cost, I am thinking
          * to avoid resetting the trickleTimer to reduce the amount of DIO sent.         *
          */
-        std::string OF = par("objectiveFunctionType").stdstringValue(); //CL 2022-11-04
-        //EV_INFO << "I am using OF:" << OF << endl;
-        if (OF == "ETX")
-            trickleTimer->reset();
-        else if (OF == "HOP_COUNT")
-            trickleTimer->reset();
-        else if (OF == "HC_MOD")
-            trickleTimer->reset();
-        else if (OF == "ML"){
-            if(simTime()<1740)
-                trickleTimer->reset();
-            else
-                sendRplPacket(createDio_Unique(), DIO, Ipv6Address::ALL_NODES_1, uniform(0, 1));  //trickleTimer->reset();
-        }else if (OF=="RPL_ENH"){
-            if (newPrefParent->getRank() + 1 == current_rank)
-                EV_INFO << "do nothing if the rank of my pref parent did not change, and only changed the path_cost" << endl;
-            else
+        switch (objectiveFunction->getOcp()) {
+            case ML:
+                if(simTime()<1740)
+                    trickleTimer->reset();
+                else
+                    sendRplPacket(createDio_Unique(), DIO, Ipv6Address::ALL_NODES_1, uniform(0, 1));  //trickleTimer->reset();
+                break;
+            case RPL_ENH:
+                if (newPrefParent->getRank() + 1 == current_rank)
+                    EV_INFO << "do nothing if the rank of my pref parent did not change, and only changed the path_cost" << endl;
+                else
+                    trickleTimer->reset();
+                break;
+            default:
                 trickleTimer->reset();
-        }else
-            trickleTimer->reset();
+        }
 
 
         if (daoEnabled) {
@@ -1397,17 +1324,25 @@ void Rpl::updatePreferredParent()
                     << " advertising " << getSelfAddress() << " reachability" << endl;
         }
     }
-    preferredParent = newPrefParent->dup();
+    setPreferredParent(*newPrefParent);
     previous_PrefParentAddr = preferredParent->getSrcAddress();  //2022-03-08
 
     /** Recalculate rank based on the objective function */
-    rank = objectiveFunction->calcRank(preferredParent);
+    rank = objectiveFunction->calcRank(preferredParent.get());
     EV_DETAIL << "My current Rank: " << rank << endl;
     //EV_DETAIL << "My HC value: " << getHC() << endl;
     //EV_DETAIL << "My ETX value: " << getETX() << endl;
 }
 
 //bool Rpl::checkPrefParentChanged(const Ipv6Address &newPrefParentAddr)  2022-03-08
+void Rpl::setPreferredParent(const RplNeighbor& neighbor)
+{
+    if (preferredParent)
+        *preferredParent = neighbor;
+    else
+        preferredParent.reset(new RplNeighbor(neighbor));
+}
+
 bool Rpl::checkPrefParentChanged(const Ipv6Address &newPrefParentAddr , const Ipv6Address &previous_PrefParentAddr)
 {
     //return !preferredParent || preferredParent->getSrcAddress() != newPrefParentAddr;
@@ -1434,12 +1369,6 @@ RplRouteData* Rpl::prepRouteData(const Dao *dao) {
 
 void Rpl::updateRoutingTable(const Ipv6Address &nextHop, const Ipv6Address &dest, RplRouteData *routeData, bool defaultRoute)
 {
-    auto route = routingTable->createRoute();
-    route->setSourceType(IRoute::MANET);
-    route->setPrefixLength(isRoot ? 128 : prefixLength);
-    route->setInterface(interfaceEntryPtr);
-    route->setDestination(dest);
-    route->setNextHop(nextHop);
     /**
      * If a route through preferred parent is being added
      * (i.e. not downward route, learned from DAO), set it as default route
@@ -1448,29 +1377,41 @@ void Rpl::updateRoutingTable(const Ipv6Address &nextHop, const Ipv6Address &dest
         routingTable->addDefaultRoute(nextHop, interfaceEntryPtr->getInterfaceId(), DEFAULT_PARENT_LIFETIME);
         EV_DETAIL << "Adding default route via " << nextHop << endl;
     }
+    if (checkDuplicateRoute(nextHop, dest, routeData))
+        return;
+
+    auto route = routingTable->createRoute();
+    route->setSourceType(IRoute::MANET);
+    route->setPrefixLength(isRoot ? 128 : prefixLength);
+    route->setInterface(interfaceEntryPtr);
+    route->setDestination(dest);
+    route->setNextHop(nextHop);
     if (routeData)
         route->setProtocolData(routeData);
 
-    if (!checkDuplicateRoute((Ipv6Route*) route))
-        routingTable->addRoute(route);
-}
-
-bool Rpl::checkDuplicateRoute(Ipv6Route *route) {
-    for (auto i = 0; i < routingTable->getNumRoutes(); i++) {
-        auto rt = routingTable->getRoute(i);
-        auto rtdest = rt->getDestinationAsGeneric().toIpv6();
-        auto dest = route->getDestinationAsGeneric().toIpv6();
-        if (dest == rtdest) {
-            if (rt->getNextHop() != route->getNextHop()) {
-                rt->setNextHop(route->getNextHop());
-                EV_DETAIL << "Duplicate route, updated next hop to " << rt->getNextHop() << " for dest " << dest << endl;
-                if (route->getProtocolData())
-                    rt->setProtocolData(route->getProtocolData());
-            }
+    routingTable->addRoute(route);
+    rplRoutes[dest] = route;
+}
+
+Ipv6Route *Rpl::findRplRoute(const Ipv6Address &dest) const {
+    auto it = rplRoutes.find(dest);
+    return it != rplRoutes.end() ? it->second : nullptr;
+}
+
+bool Rpl::checkDuplicateRoute(const Ipv6Address &nextHop, const Ipv6Address &dest, RplRouteData *routeData) {
+    auto rt = findRplRoute(dest);
+    if (!rt)
+        return false;
+    if (rt->getNextHop() != nextHop) {
+        rt->setNextHop(nextHop);
+        EV_DETAIL << "Duplicate route, updated next hop to " << rt->getNextHop() << " for dest " << dest << endl;
+        if (routeData) {
+            rt->setProtocolData(routeData);
             return true;
         }
     }
-    return false;
+    delete routeData;
+    return true;
 }
 
 void Rpl::appendRplPacketInfo(Packet *datagram) {
@@ -1506,15 +1447,22 @@ bool Rpl::packetTravelsDown(Packet *datagram) {
 
 
 bool Rpl::sourceRouted(Packet *pkt) {
-    EV_DETAIL << "Checking if packet is source-routed" << endl;;
-    try {
-        auto srh = pkt->popAtBack<SourceRoutingHeader>(B(64));
-        EV_DETAIL << "Retrieved source-routing header - " << srh << endl;
-        return true;
+    EV_DETAIL << "Checking if packet is source-routed" << endl;
+    // the SRH is the last chunk when present and nothing was popped from the back; that
+    // chunk is looked at in place, a peek could slice the packet and a typed one would
+    // try to convert any other chunk and throw
+    if (pkt->getDataLength() == b(0) || pkt->getBackOffset() != pkt->getTotalLength())
+        return false;
+    const Ptr<const Chunk>& content = pkt->getContent();
+    const Chunk *last = content.get();
+    if (content->getChunkType() == Chunk::CT_SEQUENCE) {
+        const auto& chunks = static_cast<const SequenceChunk *>(last)->getChunks();
+        last = chunks.empty() ? nullptr : chunks.back().get();
     }
-    catch (std::exception &e) { }
-
-    return false;
+    auto srh = dynamic_cast<const SourceRoutingHeader *>(last);
+    if (srh)
+        EV_DETAIL << "Found source-routing header - " << srh << endl;
+    return srh != nullptr;
 }
 
 B Rpl::getDaoLength() {
@@ -1617,15 +1565,20 @@ B Rpl::getRpiHeaderLength() {
 
 void Rpl::extractSourceRoutingData(Packet *pkt) {
     try {
-        lastTransit = new Ipv6Address(pkt->popAtBack<RplTransitInfo>(getTransitOptionsLength()).get()->getTransit());
-        lastTarget = new Ipv6Address(pkt->popAtBack<RplTargetInfo>(getTransitOptionsLength()).get()->getTarget());
+        lastTransit = pkt->popAtBack<RplTransitInfo>(getTransitOptionsLength()).get()->getTransit();
+        lastTarget = pkt->popAtBack<RplTargetInfo>(getTransitOptionsLength()).get()->getTarget();
         if (!isRoot)
             return;
 
-        sourceRoutingTable.insert( std::pair<Ipv6Address, Ipv6Address>(*lastTarget, *lastTransit) );
+        // a newer transit for a known target replaces the old one, moving its subtree
+        if (sourceRoutingTable.setTransit(lastTarget, lastTransit) == SourceRoutingTree::LOOP) {
+            EV_WARN << "Transit " << lastTransit << " for target " << lastTarget
+                    << " would create a source-routing loop, keeping the old one" << endl;
+            return;
+        }
         EV_DETAIL << "Source routing table updated with new:\n"
                 << "target: " << lastTarget << "\n transit: " << lastTransit << "\n"
-                << printMap(sourceRoutingTable) << endl;
+                << sourceRoutingTable.str() << endl;
     }
     catch (std::exception &e) {
         EV_WARN << "Couldn't pop RPL Target, Transit Information options from packet: "
@@ -1635,8 +1588,7 @@ void Rpl::extractSourceRoutingData(Packet *pkt) {
 
 INetfilter::IHook::Result Rpl::checkRplHeaders(Packet *datagram) {
     // skip further checks if node doesn't belong to a DODAG
-    auto datagramName = std::string(datagram->getFullName());
-    EV_INFO << "packet fullname " << datagramName << endl;
+    EV_INFO << "packet fullname " << datagram->getFullName() << endl;
     if (!isRoot && (preferredParent == nullptr || dodagId == Ipv6Address::UNSPECIFIED_ADDRESS))
     {
         EV_DETAIL << "Node is detached from a DODAG, " <<
@@ -1644,7 +1596,7 @@ INetfilter::IHook::Result Rpl::checkRplHeaders(Packet *datagram) {
         return ACCEPT;
     }
     EV_INFO << "before of: if(isUdp(datagram)) "<< endl;
-    if (isUdp(datagram) or isPing(datagram)) {
+    if (isUdp(datagram)) {
         // in non-storing MOP source routing header is needed for downwards traffic
         EV_INFO << "before of: if (!storing)) "<< endl;
         if (!storing) {
@@ -1682,9 +1634,9 @@ bool Rpl::destIsRoot(Packet *datagram) {
 
 void Rpl::saveDaoTransitOptions(Packet *dao) {
     try {
-        lastTransit = new Ipv6Address(dao->popAtBack<RplTransitInfo>(getTransitOptionsLength()).get()->getTransit());
-        lastTarget = new Ipv6Address(dao->popAtBack<RplTargetInfo>(getTransitOptionsLength()).get()->getTarget());
-        EV_DETAIL << "Updated lastTransit => lastTarget to: " << *lastTransit << " => " << *lastTarget << endl;
+        lastTransit = dao->popAtBack<RplTransitInfo>(getTransitOptionsLength()).get()->getTransit();
+        lastTarget = dao->popAtBack<RplTargetInfo>(getTransitOptionsLength()).get()->getTarget();
+        EV_DETAIL << "Updated lastTransit => lastTarget to: " << lastTransit << " => " << lastTarget << endl;
     }
     catch (std::exception &e) {
         EV_DETAIL << "No Target, Transit headers found on packet:\n " << *dao << endl;
@@ -1694,19 +1646,11 @@ void Rpl::saveDaoTransitOptions(Packet *dao) {
 
 void Rpl::constructSrcRoutingHeader(std::deque<Ipv6Address> &addressList, Ipv6Address dest)
 {
-    Ipv6Address nextHop = sourceRoutingTable[dest];
-    addressList.push_front(dest);
-    addressList.push_front(nextHop);
-    EV_DETAIL << "Constructing routing header for dest - " << dest << "  next hop: " << nextHop << endl;
+    EV_DETAIL << "Constructing routing header for dest - " << dest << endl;
 
-    // Create sequence of 'next hop' addresses recursively using the source routing table learned from DAOs
-    while (sourceRoutingTable.find(nextHop) != sourceRoutingTable.end())
-    {
-        nextHop = sourceRoutingTable[nextHop];
-        addressList.push_front(nextHop);
-    }
-    // pop redundant link-local next hop, which is already known from the routing table
-    addressList.pop_front();
+    // Sequence of 'next hop' addresses from the source routing tree learned from DAOs,
+    // without the root's own next hop, which is already known from the routing table
+    sourceRoutingTable.getPath(dest, addressList);
 }
 
 
@@ -1714,9 +1658,9 @@ void Rpl::appendSrcRoutingHeader(Packet *datagram) {
     Ipv6Address dest = findNetworkProtocolHeader(datagram)->getDestinationAddress().toIpv6();
     std::deque<Ipv6Address> srhAddresses;
     EV_DETAIL << "Appending routing header to datagram " << datagram << endl;
-    if ( sourceRoutingTable.find(dest) == sourceRoutingTable.end() ) {
+    if (!sourceRoutingTable.contains(dest)) {
         EV_WARN << "Required destination " << dest << " not yet present in source-routing table: \n"
-                << printMap(sourceRoutingTable) << endl;
+                << sourceRoutingTable.str() << endl;
         return;
     }
 
@@ -1724,31 +1668,32 @@ void Rpl::appendSrcRoutingHeader(Packet *datagram) {
 
     EV_DETAIL << "Source routing header constructed : " << srhAddresses << endl;
 
+    CompressedSourceRoute route;
+    route.setAddresses(srhAddresses, dest);
     auto srh = makeShared<SourceRoutingHeader>();
-    srh->setAddresses(srhAddresses);
-    srh->setChunkLength(getSrhSize());
+    srh->setRoute(route);
+    EV_DETAIL << "Compressed routing header: " << route << endl;
     datagram->insertAtBack(srh);
 }
 
 void Rpl::forwardSourceRoutedPacket(Packet *datagram) {
     EV_DETAIL << "processing source-routed datagram - " << datagram
             << "\n with routing header: " << endl;
-    auto srh = const_cast<SourceRoutingHeader *> (datagram->popAtBack<SourceRoutingHeader>(getSrhSize()).get());
+    auto srh = datagram->popAtBack<SourceRoutingHeader>();
     EV_INFO << "I'm here" << endl;
-    auto srhAddresses = srh->getAddresses();
+    auto route = srh->getRoute();
 
-    if (srhAddresses.back() == getSelfAddress()) {
+    if (route.back() == getSelfAddress()) {
         EV_DETAIL << "Source-routed destination reached" << endl;
         return;
     }
 
-    for (auto addr : srhAddresses)
-        EV_DETAIL << addr << " => ";
+    EV_DETAIL << route;
 
     Ipv6Address nextHop;
-    for (auto it = srhAddresses.cbegin(); it != srhAddresses.cend(); it++) {
-        if (it->matches(getSelfAddress(), prefixLength)) {
-            nextHop = *(++it);
+    for (int i = 0; i + 1 < route.size(); i++) {
+        if (route.get(i).matches(getSelfAddress(), prefixLength)) {
+            nextHop = route.get(i + 1);
             break;
         }
     }
@@ -1756,12 +1701,11 @@ void Rpl::forwardSourceRoutedPacket(Packet *datagram) {
 
     updateRoutingTable(nextHop, nextHop, nullptr, false);
 
-    srhAddresses.pop_front();
+    route.popFront();
 //
-    // re-insert updated routing header
+    // re-insert updated routing header, its size stays the same [RFC6554, 4.2]
     auto updatedSrh =  makeShared<SourceRoutingHeader>();
-    updatedSrh->setChunkLength(getSrhSize());
-    updatedSrh->setAddresses(srhAddresses);
+    updatedSrh->setRoute(route);
     datagram->insertAtBack(updatedSrh);
     (const_cast<NetworkHeaderBase *>(findNetworkProtocolHeader(datagram).get()))->setDestinationAddress(nextHop);
 }
@@ -1848,10 +1792,10 @@ void Rpl::deletePrefParent(bool poisoned)
     auto prefParentAddr = preferredParent->getSrcAddress();
     EV_DETAIL << "Preferred parent " << prefParentAddr
             << boolStr(poisoned, " detachment", " unreachability") << "detected" << endl;
-    emit(parentUnreachableSignal, preferredParent);
+    emit(parentUnreachableSignal, (long)preferredParent->getNodeId());
     clearParentRoutes();
     candidateParents.erase(prefParentAddr);
-    preferredParent = nullptr;
+    preferredParent.reset();
     EV_DETAIL << "Erased preferred parent from candidate parent set" << endl;
 }
 
@@ -1861,22 +1805,23 @@ void Rpl::clearParentRoutes() {
         return;
     }
 
-    Ipv6Route *routeToDelete;
-
     EV_INFO << "interface before deleting: " << interfaceEntryPtr->getInterfaceId() << endl;
     //routingTable->printRoutingTable();
     EV_INFO << "Num routes: " << routingTable->getNumRoutes() << endl;
 
     routingTable->deleteDefaultRoutes(interfaceEntryPtr->getInterfaceId());
     EV_DETAIL << "Deleted default route through preferred parent " << endl;
-    auto totalRoutes = routingTable->getNumRoutes();
-    for (int i = 0; i < totalRoutes; i++) {
-        auto ri = routingTable->getRoute(i);
-        if (ri->getNextHop() == preferredParent->getSrcAddress())
-            routeToDelete = ri;
+
+    /**
+     * Upward routes through the parent are the ones updatePreferredParent() adds,
+     * to the parent itself and to the DODAG root
+     */
+    auto parentAddr = preferredParent->getSrcAddress();
+    for (auto dest : { parentAddr, dodagId }) {
+        auto routeToDelete = findRplRoute(dest);
+        if (routeToDelete && routeToDelete->getNextHop() == parentAddr)
+            routingTable->deleteRoute(routeToDelete);
     }
-    if (routeToDelete)
-        routingTable->deleteRoute(routeToDelete);
     EV_DETAIL << "Deleted non-default route through preferred parent " << endl;
     routingTable->purgeDestCache();
 }
@@ -1902,22 +1847,15 @@ Ipv6Address Rpl::getSelfAddress() {
 }
 
 bool Rpl::checkDestKnown(const Ipv6Address &nextHop, const Ipv6Address &dest) {
-    Ipv6Route *outdatedRoute = nullptr;
-    for (int i = 0; i < routingTable->getNumRoutes(); i++) {
-        auto ri = routingTable->getRoute(i);
-        if (ri->getDestPrefix() == dest) {
-            EV_DETAIL << "Destination " << ri->getDestPrefix() << " already known, ";
-            if (ri->getNextHop() == nextHop) {
-                EV_DETAIL << "reachable via " << ri->getNextHop() << endl;
-                return true;
-            }
-            else {
-                EV_DETAIL << "but next hop has changed to "
-                        << nextHop << ", routing table to be updated" << endl;
-                outdatedRoute = ri;
-                break;
-            }
+    Ipv6Route *outdatedRoute = findRplRoute(dest);
+    if (outdatedRoute) {
+        EV_DETAIL << "Destination " << outdatedRoute->getDestPrefix() << " already known, ";
+        if (outdatedRoute->getNextHop() == nextHop) {
+            EV_DETAIL << "reachable via " << outdatedRoute->getNextHop() << endl;
+            return true;
         }
+        EV_DETAIL << "but next hop has changed to "
+                << nextHop << ", routing table to be updated" << endl;
     }
     try {
         if (outdatedRoute)
@@ -1938,7 +1876,7 @@ bool Rpl::checkUnknownDio(const Ptr<const Dio>& dio)
     return dio->getDodagId() != dodagId || dio->getInstanceId() != instanceId;
 }
 
-void Rpl::addNeighbour(const Ptr<const Dio>& dio)
+void Rpl::addNeighbour(const Ptr<const Dio>& dio, const DioRxInfo& rxInfo)
 {
     /**
      * Maintain following sets of link-local nodes:
@@ -1946,11 +1884,9 @@ void Rpl::addNeighbour(const Ptr<const Dio>& dio)
      *  - candidate parents
      * where preferred parent is chosen from the candidate parent set [RFC6560, 8.2.1]
      *
-     * In current implementation, neighbor data is represented by most recent
-     * DIO packet received from it.
+     * In current implementation, neighbor data is represented by the fields
+     * of the most recent DIO packet received from it, see RplNeighbor.
      */
-    auto dioCopy = dio->dup();
-    auto dioSender = dio->getSrcAddress();
 //NO    /** If DIO sender has equal rank, consider this node as a backup parent */
 //    EV_INFO <<"dio Ranking = "<<dio->getRank()<<" current node ranking: "<<rank << endl;
 //    if (dio->getRank() == rank) {
@@ -1965,9 +1901,9 @@ void Rpl::addNeighbour(const Ptr<const Dio>& dio)
 //        candidateParents[dioSender] = dioCopy;
 //    else  //no need to check if temp_rank is less than current rank
         /** If DIO sender has lower rank, consider this node as a candidate parent */
-        candidateParents[dioSender] = dioCopy;
+        candidateParents.update(*dio, rxInfo);
         updatePreferredParent();
-        updateMetrics_fromPrefParent(preferredParent);
+        updateMetrics_fromPrefParent(preferredParent.get());
 
 //     if (dio->getRank() < rank) {
 //        if (candidateParents.find(dioSender) != candidateParents.end())
@@ -1989,6 +1925,16 @@ void Rpl::receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj,
 //
     Enter_Method_Silent();
 
+    if (signalID == routeDeletedSignal) {
+        auto route = dynamic_cast<Ipv6Route *>(obj);
+        if (route) {
+            auto it = rplRoutes.find(route->getDestPrefix());
+            if (it != rplRoutes.end() && it->second == route)
+                rplRoutes.erase(it);
+        }
+        return;
+    }
+
     EV_DETAIL << "Processing signal - " << signalID << endl;
     if (signalID == packetReceivedSignal)
         udpPacketsRecv++;
@@ -2028,33 +1974,27 @@ void Rpl::receiveSignal(cComponent *source, simsignal_t signalID, cObject *obj,
 
 void Rpl::finish(){
 
-    auto radio = check_and_cast<Radio *>(host->getSubmodule("wlan",0)->getSubmodule("radio")); //CL: 2022-09-13
-
-    //CL, to save the ranking of each node at the end of the simulation.
-    std::ofstream file;
-    file.open("St_Ranking.txt", std::ios_base::app);
-    // meter[] rank hc etx dio_received c c1 c2 c3 c4 c5 c6 c7
-    //file << getParentModule()->getFullName() << " " << rank << " " <<"path_C: " << path_cost << " "<< hc << " " << etx << " " << "dioRx: " << dio_received <<
-    //        " " << c << " " << c1 << " " << c2 << " " << c3 << " " << c4 << " " << c5 << " " << c6 <<
-    //        " " << c7 << " rx_uns= " << radio->rx_unsuccessful << " rx_suc_rate= " << radio->rx_successful_rate << endl;
-    file << getParentModule()->getFullName() << " " << rank << " " <<"path_C: " << path_cost << " HC: " << hc << " ETX: " << etx << " " << "dioRx: " << dio_received <<
-            " " << "parents-updated: " << numParentUpdates << " neighbors: " << neighbors << endl;
-    //file << getParentModule()->getFullName() << "rank: "<< rank << " hc: " << hc<< " etx: " << etx << endl;
-    //file << "My rank respect to my Preferred parent has changed (it is worse now): " << c << endl;
-    //file << "My rank respect to my Preferred parent has not changed: " << c1 << endl;
-    //file << "My rank respect to my Preferred parent has changed (it is better now): " << c2 << endl;
-    //file << "My rank respect to a node in the parent list has changed (it is worse): " << c3 << endl;
-    //file << "My rank respect to a node in the parent list is the same as it was, nothing to do: " << c4 << endl;
-    //file << "My rank respect to a node in the parent list has changed (it is better) " << c5 << endl;
-    //file << "I'll add a new neighbor as a candidate parent: " << c6 << endl;
-    //file << "Neighbors: " << den << endl;
-
-    //macModule = getParentModule()->getSubmodule("wlan",0)->getSubmodule("mac");
-    //mac = check_and_cast<Ieee802154Mac *>(macModule);
-
-    //file << "channel utilization: " << mac->channel_util  <<endl;
-    //file << "queue utilization: " << mac->qu << endl;
-    file.close();
+    //CL, final state of each node, recorded through the @statistic declarations in Rpl.ned
+    //instead of St_Ranking.txt, so parallel runs don't share one file
+    emit(rankSignal, rank);
+    emit(pathCostSignal, path_cost);
+    emit(hopCountSignal, hc);
+    emit(etxSignal, etx);
+    emit(neighborsSignal, neighbors);
+    recordScalar("dioReceived", dio_received);
+    recordScalar("parentsUpdated", numParentUpdates);
+
+    // approximate heap use of the per-node routing state, to size large campaigns
+    size_t neighborBytes = candidateParents.getMemoryUsage() + backupParents.getMemoryUsage()
+            + unorderedMemoryUsage(counterNeighbors);
+    size_t routeBytes = unorderedMemoryUsage(rplRoutes) + sourceRoutingTable.getMemoryUsage();
+    size_t daoBytes = pendingDaoAcks.getMemoryUsage() + aggregatedTargets.capacity() * sizeof(Ipv6Address);
+    for (const auto& entry : pendingAggregatedDaos)
+        daoBytes += sizeof(entry) + 3 * sizeof(void *) + entry.second.capacity() * sizeof(Ipv6Address);
+    recordScalar("memoryNeighbors", neighborBytes, "B");
+    recordScalar("memoryRoutes", routeBytes, "B");
+    recordScalar("memoryPendingDaos", daoBytes, "B");
+    recordScalar("memoryTotal", sizeof(*this) + neighborBytes + routeBytes + daoBytes, "B");
 }
 
 double Rpl::getRank(){
@@ -2126,6 +2066,17 @@ double Rpl::getsnr_inst(){
     return snr_inst;
 }
 
+void Rpl::getLinkFeatures(FeatureRecord& record){
+    // same inputs the ML objective function scores the preferred parent with
+    record.parent = preferredParent ? preferredParent->getNodeId() : 0;
+    record.hc = hc;
+    record.bw = bw;
+    record.den = den;
+    record.etxOnLink = etx_inst;
+    record.fps = fps;
+    record.drop = dropR + dropB;
+}
+
 double Rpl::getfps(){
     return fps;
 }
@@ -2146,13 +2097,15 @@ simtime_t Rpl::getlastupdate(){
     return last_update;
 }
 
-void Rpl::updateMetrics_fromDIO (const Ptr<const Dio>& dio){
+void Rpl::updateMetrics_fromDIO (const Ptr<const Dio>& dio, const DioRxInfo& rxInfo){
 
     EV_INFO << "Updating metrics from DIO: " << endl;
     hc = dio->getHC() + 1;
     EV_INFO << "hc: " << hc << endl;
-    etx = dio->getETX() + objectiveFunction->ETX_Calculator_onLink(dio);
-    EV_INFO << "etx: " << etx << endl;
+    if (metrics & RPL_METRIC_ETX) {
+        etx = dio->getETX() + objectiveFunction->ETX_Calculator_onLink(dio);
+        EV_INFO << "etx: " << etx << endl;
+    }
 
     //auto app = check_and_cast<UdpBasicApp*> (host->getSubmodule("app", 0)); //CL to test access to app module
     //EV_INFO <<"numSent = " << app->numSent;//CL to test access to app module //CL to test access to app module
@@ -2176,7 +2129,7 @@ void Rpl::updateMetrics_fromDIO (const Ptr<const Dio>& dio){
     den = dio->getDen();
     qu = dio->getQu();
     fps = dio->getFps();
-    snr = dio->getSnr(); //2022-09-14
+    snr = rxInfo.snr; //2022-09-14
     rxuns = dio->getRx_un_suc();
     rxsucrate = dio->getRx_suc_rate();
 
@@ -2211,13 +2164,15 @@ void Rpl::updateMetrics_fromDIO (const Ptr<const Dio>& dio){
     EV_INFO << "This dio was updated at: " << last_update << endl;
 
 }
-void Rpl::updateMetrics_fromPrefParent (Dio* preferredParent){
+void Rpl::updateMetrics_fromPrefParent (const RplNeighbor* preferredParent){
 
     EV_INFO << "Updating metrics from Pref. Parent: " << endl;
     hc = preferredParent->getHC() + 1;
     EV_INFO << "hc: " << hc << endl;
-    etx = preferredParent->getETX() + objectiveFunction->ETX_Calculator_onLink_calcRank(preferredParent);
-    EV_INFO << "etx: " << etx << endl;
+    if (metrics & RPL_METRIC_ETX) {
+        etx = preferredParent->getETX() + objectiveFunction->ETX_Calculator_onLink_calcRank(preferredParent);
+        EV_INFO << "etx: " << etx << endl;
+    }
 
     //auto app = check_and_cast<UdpBasicApp*> (host->getSubmodule("app", 0)); //CL to test access to app module
     //EV_INFO <<"numSent = " << app->numSent;//CL to test access to app module //CL to test access to app module
@@ -2266,13 +2221,11 @@ void Rpl::updateMetrics_fromPrefParent (Dio* preferredParent){
 }
 
 //CL 02-02-2022
-void Rpl::updateNeighbour(const Ptr<const Dio>& dio)
+void Rpl::updateNeighbour(const Ptr<const Dio>& dio, const DioRxInfo& rxInfo)
 {
     /**
      * Based on addNeighbour
      */
-    auto dioCopy = dio->dup();
-    auto dioSender = dio->getSrcAddress();
 //NO    /** If DIO sender has equal rank, consider this node as a backup parent */
 //    EV_INFO <<"dio Ranking = "<<dio->getRank()<<" current node ranking: "<<rank << endl;
 //    if (dio->getRank() == rank) {
@@ -2289,7 +2242,7 @@ void Rpl::updateNeighbour(const Ptr<const Dio>& dio)
         /** If DIO sender has lower rank, consider this node as a candidate parent */
 
 
-    candidateParents[dioSender] = dioCopy;
+    candidateParents.update(*dio, rxInfo);
     //updatePreferredParent();
 
         //     if (dio->getRank() < rank) {
@@ -2302,23 +2255,12 @@ void Rpl::updateNeighbour(const Ptr<const Dio>& dio)
 }
 
 void Rpl::countNeighbours(const Ptr<const Dio>& dio){
-    std::vector<ParentStructure*>::iterator it;
-        for(it = counterNeighbors.begin(); it != counterNeighbors.end(); it++)
-        {
-            if(dio->getSrcAddress() == (*it)->SenderIpAddr){
-                EV_INFO <<" I already count this sender " <<endl;
-                return;
-            }
-        }
-        if (it == counterNeighbors.end()) {
-            ParentStructure* rcv = new ParentStructure();
-            rcv->SenderIpAddr = dio->getSrcAddress();
-            counterNeighbors.push_back(rcv);
-            neighbors = neighbors + 1;
-            EV_INFO <<"this node has " << den << " neighbors" <<endl;
-        }
-
+    if (!counterNeighbors.insert(dio->getSrcAddress()).second) {
+        EV_INFO <<" I already count this sender " <<endl;
         return;
+    }
+    neighbors = neighbors + 1;
+    EV_INFO <<"this node has " << den << " neighbors" <<endl;
 }
 
 void Rpl::updateMetrics_frequently () {
@@ -2337,38 +2279,38 @@ void Rpl::updateMetrics_frequently () {
         return;
     }
 
-    macModule = getParentModule()->getSubmodule("wlan",0)->getSubmodule("mac");
-    mac = check_and_cast<Ieee802154Mac *>(macModule);
-
     uint64_t nodeId = preferredParent->getNodeId();
+    const NeighborLink *link = mac->getNeighborLinks().find(nodeId);
+    double ackRcv = link ? link->recentAckReceived : 0;
+    double ackMissed = link ? link->recentAckMissed : 0;
+
+    //for SNR
+    snr_inst = link ? link->getSnr() : 0;
 
-    if (mac->getACKrcv(nodeId)==0 & mac->getACKmissed(nodeId) ==0){
+    if (ackRcv==0 & ackMissed ==0){
         etx_inst = 1;
         EV_INFO << "updating etx_int of my pref parent: " << etx_inst << endl;
         EV_INFO << "my pref parent is: " << nodeId << endl;
         //for SNR
-        snr_inst = mac->getSNRave(nodeId);
         EV_INFO << "updating snr_int of my pref parent: " << snr_inst << endl;
         EV_INFO << "my pref parent is: " << nodeId << endl;
         return ;
     }
-    if (mac->getACKrcv(nodeId) ==0) {
+    if (ackRcv ==0) {
         etx_inst = 100; //a very high ETX value
         EV_INFO << "updating etx_int of my pref parent: " << etx_inst << endl;
         EV_INFO << "my pref parent is: " << nodeId << endl;
         //for SNR
-        snr_inst = mac->getSNRave(nodeId);
         EV_INFO << "updating snr_int of my pref parent: " << snr_inst << endl;
         EV_INFO << "my pref parent is: " << nodeId << endl;
         return ;
     }
 
-    etx_inst = (mac->getACKmissed(nodeId) + mac->getACKrcv(nodeId))/mac->getACKrcv(nodeId);
+    etx_inst = link->getEtx();
 
     EV_INFO << "updating etx_int of my pref parent: " << etx_inst << endl;
 
     //for SNR
-    snr_inst = mac->getSNRave(nodeId);
     EV_INFO << "updating snr_int of my pref parent: " << snr_inst << endl;
     EV_INFO << "my pref parent is: " << nodeId << endl;
 
@@ -2376,139 +2318,13 @@ void Rpl::updateMetrics_frequently () {
 
 }
 
-void Rpl::connecting()
-{
-    EV_INFO << "connecting" << endl;
-
-    /*
-        Create a TCP socket
-    */
-
-
-    #pragma comment(lib,"ws2_32.lib") //Winsock Library
-
-    //int main(int argc , char *argv[])
-    //{
-        WSADATA wsa;
-        SOCKET s;
-        struct sockaddr_in server;
-        const char *message ;
-        char *space = " " ;
-        char server_reply [2000];
-        int recv_size;
-
-        printf("\nInitialising Winsock...");
-
-        if (WSAStartup(MAKEWORD(2,2),&wsa) != 0)
-        {
-            //EV_INFO << "Failed. Error Code : %d", WSAGetLastError() << endl;
-            //return 1;
-        }
-
-        EV_INFO << "Initialised" << endl ;
-
-        //Create a socket
-        if((s = socket(AF_INET , SOCK_STREAM , 0 )) == INVALID_SOCKET)
-        {
-            //EV_INFO << "Could not create socket : %d" , WSAGetLastError() << endl;
-        }
-
-        EV_INFO << "Socket created" << endl ;
-
-
-        server.sin_addr.s_addr = inet_addr("127.0.0.1");
-        server.sin_family = AF_INET;
-        server.sin_port = htons( 8080 );
-
-        //Connect to remote server
-        if (connect(s , (struct sockaddr *)&server , sizeof(server)) < 0)
-        {
-            puts("connect error");
-           // return 1;
-        }
-
-        puts("Connected");
-        EV_INFO <<"conected"<< endl;
-        //return 0;
-
-        //Send some data
-        //message = sprintf(2.53) ;//"GET / HTTP/1.1\r\n\r\n";
-        double num = 2.53;
-        //std::stringstream ss;
-        //ss << i;
-        //message = ss.str();
-        //message = ss.str();
-        //char ch = static_cast<char>(i);
-        //send(socketClient, (void*)&userDataBuffer[i], sizeof(double), 0);
-        //if(sendto(s , message , strlen(message) , 0 ,0,0) < 0)
-       // std::string st = std::to_string(num);
-       // message = st.c_str();
-
-        //Custom precision
-        std::ostringstream streamObj;
-        streamObj << std::fixed;
-        streamObj << std::setprecision(2);
-        streamObj << num;
-        std::string strObj = streamObj.str() + " " + streamObj.str() +  " " + streamObj.str() + " " + streamObj.str()
-                + " " + streamObj.str() + " " + streamObj.str() ;
-        message = strObj.c_str();
-
-        sendto(s , message , strlen(message) , 0 , 0, 0 );
-    /*    sendto(s , space , strlen(space) , 0 , 0, 0 );
-        sendto(s , message , strlen(message) , 0 , 0, 0 );
-        sendto(s , space , strlen(space) , 0 , 0, 0 );
-        sendto(s , message , strlen(message) , 0 , 0, 0 );
-        sendto(s , space , strlen(space) , 0 , 0, 0 );
-        sendto(s , message , strlen(message) , 0 , 0, 0 ); */
-    /*        {
-                puts("Send failed");
-                //return 1;
-            }
-            puts("Data Send\n"); */
-
-            //return 0;
-
-            //Receive a reply from the server
-                if((recv_size = recv(s , server_reply , 2000 , 0)) == SOCKET_ERROR)
-                {
-                    //puts("recv failed");
-                    EV_INFO << "rec failed" << endl ;
-                }
-
-                //puts("Reply received\n");
-                //EV_INFO << "rec failed" << endl ;
-
-                //Add a NULL terminating character to make it a proper string before printing
-                //server_reply[recv_size] = '\0';
-                //puts(server_reply);
-
-                // convert string to float
-                //float num_float = std::stof(server_reply);
-
-                // convert string to double
-                double num_double = std::stod(server_reply);
-                EV_INFO << "server reply: " << num_double << endl;
-
-                std::ofstream file;
-                file.open("St_RankingCalcReplayfromML.txt", std::ios_base::app);
-                file << getParentModule()->getFullName() << " received: " << num_double << endl;
-                file.close();
-
-
-            //recv_size = recv(s , server_reply , 2000 , 0)
-
-            closesocket(s);
-            WSACleanup();
-    //}
-}
-
 void Rpl::updateBestCandidate()
 {
     //2022-04-11: To be used later to see if the rank changed
     //double current_rank = rank;
 
     //Dio *newPrefParent;
-    Dio *newBestForwardingCandidate;
+    const RplNeighbor *newBestForwardingCandidate;
     EV_DETAIL << "Choosing the best forwarding candidate from "
             << boolStr(candidateParents.empty() && par("useBackupAsPreferred").boolValue(),
                     "backup", "candidate") << " parent set" << endl;
@@ -2540,9 +2356,7 @@ void Rpl::updateBestCandidate()
 //    if (!(checkPrefParentChanged(newPrefParentAddr,previous_PrefParentAddr))) {  //2022-03-08
 
         //CL: if it is here is because the preferred parent changed otherwise it was only updated
-        std::ofstream file;  // CL 2022-02-02
-        file.open("St_BestForwardingCandidatesChanges.txt", std::ios_base::app);
-        file << simTime() <<" " << getParentModule()->getFullName() << " The best forwarding candidate is: " << newBestForwardingCandidateAddr << endl;
+        TraceSink::line("St_BestForwardingCandidatesChanges.txt") << simTime() <<" " << getParentModule()->getFullName() << " The best forwarding candidate is: " << newBestForwardingCandidateAddr << endl;
         //
 
         //auto newPrefParentDodagId = newPrefParent->getDodagId();
@@ -2571,8 +2385,8 @@ void Rpl::updateBestCandidate()
         if (newBestForwardingCandidateAddr != dodagId)
             updateRoutingTable(newBestForwardingCandidateAddr, newBestForwardingCandidateAddr, nullptr, false);
 
-        lastTransit = new Ipv6Address(newBestForwardingCandidateAddr);
-        EV_DETAIL << "Updated best forwarding candidate - " << newBestForwardingCandidate << endl;
+        lastTransit = newBestForwardingCandidateAddr;
+        EV_DETAIL << "Updated best forwarding candidate - " << newBestForwardingCandidateAddr << endl;
         //preferredParent = newBestForwardingCandidate->dup(); //I included this line after getting an error
 
         //numParentUpdates++;
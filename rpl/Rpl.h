@@ -22,8 +22,15 @@
 #ifndef _RPL_H
 #define _RPL_H
 
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "inet/routing/rpl/TrickleTimer.h"
 #include "inet/routing/rpl/RplRouteData.h"
+#include "inet/routing/rpl/NeighborTable.h"
+#include "inet/routing/rpl/SourceRoutingTree.h"
+#include "inet/routing/rpl/DaoAckTimerWheel.h"
 #include "inet/applications/udpapp/UdpBasicApp.h"
 #include "inet/applications/udpapp/UdpSink.h"
 #include "inet/common/packet/dissector/PacketDissector.h"
@@ -40,7 +47,6 @@
 //#include <pyembed.h>
 //#include "C:/Users/carlo/Anaconda3/Python.h"
 #include<stdio.h>
-#include <winsock.h>
 #include "inet/physicallayer/common/packetlevel/Radio.h"  //CL 2022-09-12
 //The next 3 lines were added by CL so that Radio Module can be recognized
 #ifdef WITH_RADIO
@@ -51,6 +57,7 @@ namespace inet {
 
 class RplRouteData;  //CL 2021-12-03: to avoid circular dependency
 class ObjectiveFunction;  // 2022-04-28: to avoid circular dependency between Rpl.h and ObjectiveFunction.h
+struct FeatureRecord;
 
 class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::HookBase
 {
@@ -71,11 +78,15 @@ class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::
     uint8_t dodagVersion;
     Ipv6Address dodagId;
     Ipv6Address selfAddr;
-    Ipv6Address *lastTarget;
-    Ipv6Address *lastTransit;
+    Ipv6Address lastTarget;
+    Ipv6Address lastTransit;
     uint8_t instanceId;
     double daoDelay;
     double daoAckTimeout;
+    double daoAggregationWindow;
+    int daoAggregationMaxTargets;
+    cMessage *daoAggregationTimer = nullptr;
+    std::vector<Ipv6Address> aggregatedTargets; // learned within the current window, not forwarded yet
     double clKickoffTimeout; // timeout for auto-triggering phase II of CL SF
     uint8_t daoRtxCtn;
     uint8_t daoRtxThresh;
@@ -93,19 +104,31 @@ class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::
     uint32_t branchChOffset;
     uint16_t branchSize;
     int daoSeqNum;
-    Dio *preferredParent;
+    std::unique_ptr<RplNeighbor> preferredParent;
     Ipv6Address previous_PrefParentAddr ;
-    std::string objectiveFunctionType;
-    std::map<Ipv6Address, Dio *> backupParents;
-    std::map<Ipv6Address, Dio *> candidateParents;
-    std::map<Ipv6Address, Ipv6Address> sourceRoutingTable;
-    std::map<Ipv6Address, std::pair<cMessage *, uint8_t>> pendingDaoAcks;
+    int metrics;    // RplMetric groups advertised in DIOs and tracked per neighbor
+    NeighborTable backupParents;
+    NeighborTable candidateParents;
+    SourceRoutingTree sourceRoutingTable;
+    /**
+     * Routes this module added to the routing table, by destination. Entries are
+     * added in updateRoutingTable() and dropped on routeDeletedSignal, so the index
+     * also follows deletions done by the routing table itself (e.g. on expiry).
+     */
+    std::unordered_map<Ipv6Address, Ipv6Route *, Ipv6AddressHash> rplRoutes;
+    DaoAckTimerWheel pendingDaoAcks;
+    std::map<Ipv6Address, std::vector<Ipv6Address>> pendingAggregatedDaos; // targets of multi-target DAOs in pendingDaoAcks
 
     /** Statistics collection */
     simsignal_t dioReceivedSignal;
     simsignal_t daoReceivedSignal;
     simsignal_t parentChangedSignal;
     simsignal_t parentUnreachableSignal;
+    simsignal_t rankSignal;
+    simsignal_t pathCostSignal;
+    simsignal_t hopCountSignal;
+    simsignal_t etxSignal;
+    simsignal_t neighborsSignal;
 
     /*************CL*******************/
     cOutVector DIOsent;
@@ -155,12 +178,8 @@ class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::
 
     //double thre = 0.5 ;
 
-    //To get variables from L2   CL 2021-12-10
-    cModule *macModule = nullptr;
+    //To get variables from L2 and from the Radio module, bound once from the host's HostBindings
     Ieee802154Mac *mac = nullptr;
-
-    //To get variables form Radio module CL 2022-09-12
-    cModule *radioModule = nullptr;
     Radio *radio = nullptr;
 
     //struct ParentStructure {          //I moved this part to the ObjectiveFunction.h
@@ -169,11 +188,7 @@ class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::
         //std::string ParentName;
     //};
 
-    struct ParentStructure {
-       Ipv6Address SenderIpAddr;
-    };
-    typedef std::vector<ParentStructure*> CounterCache;
-    CounterCache counterNeighbors;
+    std::unordered_set<Ipv6Address, Ipv6AddressHash> counterNeighbors;   // senders of all DIOs received
 
    /*************end CL****************/
 
@@ -188,7 +203,7 @@ class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::
     bool isLeaf;
     uint8_t detachedTimeout; // temporary variable to suppress msg processing after just leaving the DODAG
     cMessage *detachedTimeoutEvent; // temporary msg corresponding to triggering above functionality
-    cMessage *daoAckTimeoutEvent; // temporary msg corresponding to triggering above functionality
+    cMessage *daoAckTimeoutEvent; // ticks pendingDaoAcks while a DAO_ACK timeout is armed
     uint8_t prefixLength;
     Coord position;
     uint64_t selfId;    // Primary IE MAC address in decimal
@@ -251,8 +266,11 @@ class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::
    double getetx_int();
    double getsnr_inst();
 
-    void updateMetrics_fromDIO (const Ptr<const Dio>& dio);  //CL 2021-12-02
-    void updateMetrics_fromPrefParent (Dio* preferredParent); //CL 2022-01-29
+   /** Fills the preferred parent link features of a FeatureExport hop */
+   void getLinkFeatures(FeatureRecord& record);
+
+    void updateMetrics_fromDIO (const Ptr<const Dio>& dio, const DioRxInfo& rxInfo);  //CL 2021-12-02
+    void updateMetrics_fromPrefParent (const RplNeighbor* preferredParent); //CL 2022-01-29
 
     cMessage *metric_updater_timer ;   //CL 2022-02-22
     void updateMetrics_frequently ();  //CL 2022-02-22
@@ -313,7 +331,27 @@ class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::
      */
     void processDao(const Ptr<const Dao>& dao);
 //    void retransmitDao(Dao *dao);
-    void retransmitDao(Ipv6Address advDest);
+    /**
+     * Retransmit DAOs whose DAO_ACK timed out in the same tick of pendingDaoAcks,
+     * in storing mode as one multi-target DAO
+     */
+    void retransmitDaos(const std::vector<Ipv6Address> &advDests);
+    void processDaoAckTimeouts();
+    /** (Re)schedule daoAckTimeoutEvent for the earliest armed DAO_ACK timeout, pendingDaoAcks must be armed */
+    void scheduleDaoAckTimeout();
+
+    /**
+     * Queue targets learned from a DAO, they are sent upwards together
+     * by sendAggregatedDaos() when the aggregation window expires
+     */
+    void aggregateDaoTargets(const std::vector<Ipv6Address> &targets);
+    void sendAggregatedDaos();
+
+    /**
+     * Send @param targets to the preferred parent in multi-target DAOs of at most
+     * daoAggregationMaxTargets targets, starting from @param retries retransmissions
+     */
+    void sendMultiTargetDaos(const std::vector<Ipv6Address> &targets, double delay, int retries);
 
     /**
      * Process DAO_ACK packet if daoAckRequried flag is set
@@ -344,6 +382,9 @@ class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::
 
     const Ptr<Dio> createDio_Unique();  //CL 11/16/2022
 
+    /** Fill in the DIO metrics in the RplMetric groups the objective function reads */
+    void setDioMetrics(const Ptr<Dio>& dio);
+
     /**
      * Create DAO packet advertising destination reachability
      *
@@ -353,6 +394,8 @@ class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::
     const Ptr<Dao> createDao(const Ipv6Address &reachableDest, uint8_t channelOffset);
     const Ptr<Dao> createDao(const Ipv6Address &reachableDest, bool ackRequired);
     const Ptr<Dao> createDao() {return createDao(getSelfAddress()); };
+    /** Multi-target DAO, the first target is the reachable destination, all of them are known targets */
+    const Ptr<Dao> createDao(const std::vector<Ipv6Address> &targets);
     const Ptr<Dao> createDao(const Ipv6Address &reachableDest) {
         return createDao(reachableDest, (uint8_t) UNDEFINED_CH_OFFSET);
     }
@@ -376,8 +419,9 @@ class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::
      *  - candidate parents
      *
      * @param dio DIO packet received recently
+     * @param rxInfo receive-side annotations of the DIO (average SNR, rx time)
      */
-    void addNeighbour(const Ptr<const Dio>& dio);
+    void addNeighbour(const Ptr<const Dio>& dio, const DioRxInfo& rxInfo);
 
     /**
      * Delete preferred parent and related info:
@@ -395,6 +439,9 @@ class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::
      */
     void updatePreferredParent();
 
+    /** Keep a copy of @param neighbor as preferred parent, reusing the current entry */
+    void setPreferredParent(const RplNeighbor& neighbor);
+
     /************ Lifecycle ****************/
 
     virtual void handleStartOperation(LifecycleOperation *operation) override { start(); }
@@ -439,7 +486,7 @@ class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::
 
     bool selfGeneratedPkt(Packet *pkt);
     bool isUdpSink();
-    void purgeRoutingTable();
+    void purgeRoutingTable(); // deletes the RPL-owned routes only
 
     /**
      * Check if destination advertised in DAO is already stored in
@@ -524,17 +571,15 @@ class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::
     B getRpiHeaderLength();
     B getDaoLength();
 
-    // TODO: replace by dynamic calculation based on the number of addresses in source routing header
-    // + additional field specifying length of this header to allow proper decapsulation
-    B getSrhSize() { return B(64); }
-
-    bool isDao(Packet *pkt) { return std::string(pkt->getFullName()).find("Dao") != std::string::npos; }
-    bool isUdp(Packet *datagram) { return std::string(datagram->getFullName()).find("Udp") != std::string::npos; }
-
-    //CL to allow to use SRH with others applications
-    //bool isPing(Packet *datagram) { return std::string(datagram->getFullName()).find("ping") != std::string::npos; }
-    bool isPing(Packet *datagram) { return std::string(datagram->getFullName()).find("dADR") != std::string::npos; }
-    //modification in isPing because I changed the name of the application 2022/01/19
+    /**
+     * Application traffic that needs RPL headers: UdpBasicApp packets and, since the
+     * application was renamed (2022/01/19), the demand reads ("dADR..."). Other UDP
+     * traffic, e.g. the meters' "d*" packets, is left alone. The name is searched in place
+     */
+    bool isUdp(Packet *datagram) {
+        const char *name = datagram->getFullName();
+        return strstr(name, "Udp") != nullptr || strstr(name, "dADR") != nullptr;
+    }
 
     /**
      * Used by sink to collect Transit -> Target reachability information
@@ -586,7 +631,14 @@ class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::
      */
     bool checkRplRouteInfo(Packet *datagram);
 
-    bool checkDuplicateRoute(Ipv6Route *route);
+    /**
+     * Update the next hop (and route data, if given) of a known route to @param dest
+     * @return true if such a route exists, @param routeData is then owned by it or freed
+     */
+    bool checkDuplicateRoute(const Ipv6Address &nextHop, const Ipv6Address &dest, RplRouteData *routeData);
+
+    /** @return route to @param dest added by this module, nullptr if there is none */
+    Ipv6Route *findRplRoute(const Ipv6Address &dest) const;
 
     /**
      * Check if packet has source-routing header (SRH) present
@@ -655,12 +707,10 @@ class Rpl : public RoutingProtocolBase, public cListener, public NetfilterBase::
 
     void finish() override; //CL
 
-    void updateNeighbour(const Ptr<const Dio>& dio); //CL 2022-02-02
+    void updateNeighbour(const Ptr<const Dio>& dio, const DioRxInfo& rxInfo); //CL 2022-02-02
 
     void countNeighbours(const Ptr<const Dio>& dio); //CL 2022-02-19
 
-    void connecting();
-
     //void updateBestCandidate (); //2022-11-08
 
 };
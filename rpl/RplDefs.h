@@ -39,6 +39,19 @@ namespace inet {
 /** Objective function parameters */
 #define DEFAULT_MIN_HOP_RANK_INCREASE 0x100
 
+/**
+ * Groups of DIO metrics, as bit flags. An objective function declares the ones
+ * it reads, the others are neither advertised nor tracked per neighbor.
+ */
+enum RplMetric {
+    RPL_METRIC_HOP_COUNT = 1 << 0,      // HC
+    RPL_METRIC_ETX = 1 << 1,            // path ETX and the on-link ETX EWMA behind it
+    RPL_METRIC_LINK_QUALITY = 1 << 2,   // MAC drops, missed ACKs, fail rates, channel utilization, frame rate, density, queue
+    RPL_METRIC_RADIO = 1 << 3,          // SNR and radio rx success
+    RPL_METRIC_PATH_COST = 1 << 4,      // path cost through the best forwarding candidate
+    RPL_METRICS_ALL = (1 << 5) - 1
+};
+
 /** Misc */
 #define DEFAULT_PARENT_LIFETIME 5000
 #define UNDEFINED_CH_OFFSET 127
@@ -55,7 +68,8 @@ enum RPL_SELF_MSG {
     DETACHED_TIMEOUT,
     DAO_ACK_TIMEOUT,
     RPL_START,
-    METRIC_TIMER      //added by CL 2022-02-22
+    METRIC_TIMER,      //added by CL 2022-02-22
+    DAO_AGGREGATION
 };
 
 struct SlotframeChunk
@@ -105,6 +119,26 @@ inline std::ostream& operator<<(std::ostream& os, std::vector<int> const& vec)
    return os;
 }
 
+/** Hash over the four 32-bit words of an address, for unordered containers keyed by Ipv6Address */
+struct Ipv6AddressHash
+{
+    size_t operator()(const Ipv6Address& address) const {
+        const uint32_t *words = address.words();
+        size_t hash = words[0];
+        for (int i = 1; i < 4; i++)
+            hash = hash * 0x9E3779B1u + words[i];
+        return hash;
+    }
+};
+
+/** Approximate heap use of an unordered container: one node per element plus the bucket array */
+template<typename Container>
+size_t unorderedMemoryUsage(const Container& container)
+{
+    return container.size() * (sizeof(typename Container::value_type) + 2 * sizeof(void *))
+            + container.bucket_count() * sizeof(void *);
+}
+
 } // namespace inet
 
 #endif
@@ -0,0 +1,51 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "inet/routing/rpl/RplEnh2ObjectiveFunction.h"
+#include "inet/routing/rpl/TraceSink.h"
+
+namespace inet {
+
+Define_Module(RplEnh2ObjectiveFunction);
+
+const RplNeighbor *RplEnh2ObjectiveFunction::GetBestCandidate(const NeighborTable& candidateParents)
+{
+    EV_DETAIL << "List of candidate parents: "<<endl;  //CL
+
+    TraceChannel *file = TraceSink::getInstance().getChannel("St_BestCandidateDecision.txt");
+    TraceLine(file) << simTime() << ": " << getParentModule()->getParentModule()->getFullName() << endl;
+    TraceLine(file) << "List of candidate parents: " << endl;
+
+    for (const auto& cp : candidateParents){
+        EV_DETAIL << cp.getSrcAddress() << " - " << "Ranking: " <<cp.getRank() <<" - " << "path_cost: " <<cp.getPath_cost() << " - " << "last_update: " << cp.getLast_update() << endl;
+        TraceLine(file) << cp.getSrcAddress() << " - " << "Ranking: " <<cp.getRank() <<" - " << "path_cost: " <<cp.getPath_cost() << " - " << "last_update: " << cp.getLast_update() << endl;
+    }
+    TraceLine(file) << "--------------- " << endl ;
+
+    // only neighbors sharing the lowest rank can win, the path cost is computed just for them
+    std::vector<const RplNeighbor *> candidates = getLowestRankScanOrder(candidateParents);
+    double current_path_cost_score;
+    const RplNeighbor *bestCandidate = getLowestRankLowestScore(candidates, getPathCostsThrough(candidates, 10000, 0), current_path_cost_score, true);
+    EV_INFO <<"Path cost through the best forwarding candidate = " << current_path_cost_score << endl;
+    return bestCandidate;
+}
+
+} // namespace inet
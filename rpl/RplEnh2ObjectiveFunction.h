@@ -0,0 +1,44 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _RPLENH2OBJECTIVEFUNCTION_H
+#define _RPLENH2OBJECTIVEFUNCTION_H
+
+#include "inet/routing/rpl/HopCountObjectiveFunction.h"
+
+namespace inet {
+
+/**
+ * Hop count objective function for the preferred parent, with the best
+ * forwarding candidate picked among the lowest-rank neighbors by path cost.
+ */
+class INET_API RplEnh2ObjectiveFunction : public HopCountObjectiveFunction
+{
+  public:
+    virtual Ocp getOcp() const override { return RPL_ENH2; }
+    virtual int getRequiredMetrics() const override { return RPL_METRIC_HOP_COUNT | RPL_METRIC_ETX | RPL_METRIC_LINK_QUALITY | RPL_METRIC_PATH_COST; }
+
+    virtual const RplNeighbor* GetBestCandidate(const NeighborTable& candidateParents) override;
+};
+
+} // namespace inet
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "inet/routing/rpl/RplEnhObjectiveFunction.h"
+
+namespace inet {
+
+Define_Module(RplEnhObjectiveFunction);
+
+const RplNeighbor *RplEnhObjectiveFunction::selectPreferredParent(const NeighborTable& candidateParents, const RplNeighbor *currentPreferredParent)
+{
+    // only neighbors sharing the lowest rank can win, the path cost is computed just for them
+    std::vector<const RplNeighbor *> candidates = getLowestRankScanOrder(candidateParents);
+    double current_path_cost_score;
+    const RplNeighbor *newPrefParent = getLowestRankLowestScore(candidates, getPathCostsThrough(candidates, 600, 1), current_path_cost_score, true);
+    EV_INFO <<"Path cost = " << current_path_cost_score << endl;
+
+    double currentPrefParent_path_cost_score = currentPreferredParent->getPath_cost() + Path_Cost_Calculator(currentPreferredParent);
+    if (newPrefParent->getRank() == currentPreferredParent->getRank() && current_path_cost_score == currentPrefParent_path_cost_score) {
+        EV_INFO << "Preferred parent did not change b/c the new one has the same ranking and tie-breaker score"  << endl ;
+        return currentPreferredParent;
+    }
+    return newPrefParent;
+}
+
+} // namespace inet
@@ -0,0 +1,47 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _RPLENHOBJECTIVEFUNCTION_H
+#define _RPLENHOBJECTIVEFUNCTION_H
+
+#include "inet/routing/rpl/ObjectiveFunction.h"
+
+namespace inet {
+
+/**
+ * Hop count objective function whose ties among the lowest-rank neighbors are
+ * broken by the path cost to the root, so an equal-rank DIO can change the
+ * preferred parent.
+ */
+class INET_API RplEnhObjectiveFunction : public ObjectiveFunction
+{
+  public:
+    virtual Ocp getOcp() const override { return RPL_ENH; }
+    virtual int getRequiredMetrics() const override { return RPL_METRIC_HOP_COUNT | RPL_METRIC_ETX | RPL_METRIC_LINK_QUALITY | RPL_METRIC_PATH_COST; }
+    virtual bool reevaluatesOnEqualRank() const override { return true; }
+
+  protected:
+    virtual const RplNeighbor *selectPreferredParent(const NeighborTable& candidateParents, const RplNeighbor *currentPreferredParent) override;
+};
+
+} // namespace inet
+
+#endif
@@ -2052,6 +2052,7 @@ Dao::Dao(const Dao& other) : ::inet::RplPacket(other)
 
 Dao::~Dao()
 {
+    delete [] this->knownTargets;
 }
 
 Dao& Dao::operator=(const Dao& other)
@@ -2068,6 +2069,12 @@ void Dao::copy(const Dao& other)
     this->daoAckRequired = other.daoAckRequired;
     this->reachableDest = other.reachableDest;
     this->chOffset = other.chOffset;
+    delete [] this->knownTargets;
+    this->knownTargets = (other.knownTargets_arraysize==0) ? nullptr : new Ipv6Address[other.knownTargets_arraysize];
+    knownTargets_arraysize = other.knownTargets_arraysize;
+    for (size_t i = 0; i < knownTargets_arraysize; i++) {
+        this->knownTargets[i] = other.knownTargets[i];
+    }
 }
 
 void Dao::parsimPack(omnetpp::cCommBuffer *b) const
@@ -2077,6 +2084,8 @@ void Dao::parsimPack(omnetpp::cCommBuffer *b) const
     doParsimPacking(b,this->daoAckRequired);
     doParsimPacking(b,this->reachableDest);
     doParsimPacking(b,this->chOffset);
+    b->pack(knownTargets_arraysize);
+    doParsimArrayPacking(b,this->knownTargets,knownTargets_arraysize);
 }
 
 void Dao::parsimUnpack(omnetpp::cCommBuffer *b)
@@ -2086,6 +2095,14 @@ void Dao::parsimUnpack(omnetpp::cCommBuffer *b)
     doParsimUnpacking(b,this->daoAckRequired);
     doParsimUnpacking(b,this->reachableDest);
     doParsimUnpacking(b,this->chOffset);
+    delete [] this->knownTargets;
+    b->unpack(knownTargets_arraysize);
+    if (knownTargets_arraysize == 0) {
+        this->knownTargets = nullptr;
+    } else {
+        this->knownTargets = new Ipv6Address[knownTargets_arraysize];
+        doParsimArrayUnpacking(b,this->knownTargets,knownTargets_arraysize);
+    }
 }
 
 uint8_t Dao::getSeqNum() const
@@ -2132,6 +2149,74 @@ void Dao::setChOffset(uint8_t chOffset)
     this->chOffset = chOffset;
 }
 
+size_t Dao::getKnownTargetsArraySize() const
+{
+    return knownTargets_arraysize;
+}
+
+const Ipv6Address& Dao::getKnownTargets(size_t k) const
+{
+    if (k >= knownTargets_arraysize) throw omnetpp::cRuntimeError("Array of size knownTargets_arraysize indexed by %lu", (unsigned long)k);
+    return this->knownTargets[k];
+}
+
+void Dao::setKnownTargetsArraySize(size_t newSize)
+{
+    handleChange();
+    Ipv6Address *knownTargets2 = (newSize==0) ? nullptr : new Ipv6Address[newSize];
+    size_t minSize = knownTargets_arraysize < newSize ? knownTargets_arraysize : newSize;
+    for (size_t i = 0; i < minSize; i++)
+        knownTargets2[i] = this->knownTargets[i];
+    delete [] this->knownTargets;
+    this->knownTargets = knownTargets2;
+    knownTargets_arraysize = newSize;
+}
+
+void Dao::setKnownTargets(size_t k, const Ipv6Address& knownTargets)
+{
+    if (k >= knownTargets_arraysize) throw omnetpp::cRuntimeError("Array of size  indexed by %lu", (unsigned long)k);
+    handleChange();
+    this->knownTargets[k] = knownTargets;
+}
+
+void Dao::insertKnownTargets(size_t k, const Ipv6Address& knownTargets)
+{
+    if (k > knownTargets_arraysize) throw omnetpp::cRuntimeError("Array of size  indexed by %lu", (unsigned long)k);
+    handleChange();
+    size_t newSize = knownTargets_arraysize + 1;
+    Ipv6Address *knownTargets2 = new Ipv6Address[newSize];
+    size_t i;
+    for (i = 0; i < k; i++)
+        knownTargets2[i] = this->knownTargets[i];
+    knownTargets2[k] = knownTargets;
+    for (i = k + 1; i < newSize; i++)
+        knownTargets2[i] = this->knownTargets[i-1];
+    delete [] this->knownTargets;
+    this->knownTargets = knownTargets2;
+    knownTargets_arraysize = newSize;
+}
+
+void Dao::insertKnownTargets(const Ipv6Address& knownTargets)
+{
+    insertKnownTargets(knownTargets_arraysize, knownTargets);
+}
+
+void Dao::eraseKnownTargets(size_t k)
+{
+    if (k >= knownTargets_arraysize) throw omnetpp::cRuntimeError("Array of size  indexed by %lu", (unsigned long)k);
+    handleChange();
+    size_t newSize = knownTargets_arraysize - 1;
+    Ipv6Address *knownTargets2 = (newSize == 0) ? nullptr : new Ipv6Address[newSize];
+    size_t i;
+    for (i = 0; i < k; i++)
+        knownTargets2[i] = this->knownTargets[i];
+    for (i = k; i < newSize; i++)
+        knownTargets2[i] = this->knownTargets[i+1];
+    delete [] this->knownTargets;
+    this->knownTargets = knownTargets2;
+    knownTargets_arraysize = newSize;
+}
+
 class DaoDescriptor : public omnetpp::cClassDescriptor
 {
   private:
@@ -2141,6 +2226,7 @@ class DaoDescriptor : public omnetpp::cClassDescriptor
         FIELD_daoAckRequired,
         FIELD_reachableDest,
         FIELD_chOffset,
+        FIELD_knownTargets,
     };
   public:
     DaoDescriptor();
@@ -2203,7 +2289,7 @@ const char *DaoDescriptor::getProperty(const char *propertyname) const
 int DaoDescriptor::getFieldCount() const
 {
     omnetpp::cClassDescriptor *basedesc = getBaseClassDescriptor();
-    return basedesc ? 4+basedesc->getFieldCount() : 4;
+    return basedesc ? 5+basedesc->getFieldCount() : 5;
 }
 
 unsigned int DaoDescriptor::getFieldTypeFlags(int field) const
@@ -2219,8 +2305,9 @@ unsigned int DaoDescriptor::getFieldTypeFlags(int field) const
         FD_ISEDITABLE,    // FIELD_daoAckRequired
         0,    // FIELD_reachableDest
         FD_ISEDITABLE,    // FIELD_chOffset
+        FD_ISARRAY,    // FIELD_knownTargets
     };
-    return (field >= 0 && field < 4) ? fieldTypeFlags[field] : 0;
+    return (field >= 0 && field < 5) ? fieldTypeFlags[field] : 0;
 }
 
 const char *DaoDescriptor::getFieldName(int field) const
@@ -2236,8 +2323,9 @@ const char *DaoDescriptor::getFieldName(int field) const
         "daoAckRequired",
         "reachableDest",
         "chOffset",
+        "knownTargets",
     };
-    return (field >= 0 && field < 4) ? fieldNames[field] : nullptr;
+    return (field >= 0 && field < 5) ? fieldNames[field] : nullptr;
 }
 
 int DaoDescriptor::findField(const char *fieldName) const
@@ -2248,6 +2336,7 @@ int DaoDescriptor::findField(const char *fieldName) const
     if (fieldName[0] == 'd' && strcmp(fieldName, "daoAckRequired") == 0) return base+1;
     if (fieldName[0] == 'r' && strcmp(fieldName, "reachableDest") == 0) return base+2;
     if (fieldName[0] == 'c' && strcmp(fieldName, "chOffset") == 0) return base+3;
+    if (fieldName[0] == 'k' && strcmp(fieldName, "knownTargets") == 0) return base+4;
     return basedesc ? basedesc->findField(fieldName) : -1;
 }
 
@@ -2264,8 +2353,9 @@ const char *DaoDescriptor::getFieldTypeString(int field) const
         "bool",    // FIELD_daoAckRequired
         "inet::Ipv6Address",    // FIELD_reachableDest
         "uint8_t",    // FIELD_chOffset
+        "inet::Ipv6Address",    // FIELD_knownTargets
     };
-    return (field >= 0 && field < 4) ? fieldTypeStrings[field] : nullptr;
+    return (field >= 0 && field < 5) ? fieldTypeStrings[field] : nullptr;
 }
 
 const char **DaoDescriptor::getFieldPropertyNames(int field) const
@@ -2304,6 +2394,7 @@ int DaoDescriptor::getFieldArraySize(void *object, int field) const
     }
     Dao *pp = (Dao *)object; (void)pp;
     switch (field) {
+        case FIELD_knownTargets: return pp->getKnownTargetsArraySize();
         default: return 0;
     }
 }
@@ -2336,6 +2427,7 @@ std::string DaoDescriptor::getFieldValueAsString(void *object, int field, int i)
         case FIELD_daoAckRequired: return bool2string(pp->getDaoAckRequired());
         case FIELD_reachableDest: return pp->getReachableDest().str();
         case FIELD_chOffset: return ulong2string(pp->getChOffset());
+        case FIELD_knownTargets: return pp->getKnownTargets(i).str();
         default: return "";
     }
 }
@@ -2381,6 +2473,7 @@ void *DaoDescriptor::getFieldStructValuePointer(void *object, int field, int i)
     Dao *pp = (Dao *)object; (void)pp;
     switch (field) {
         case FIELD_reachableDest: return toVoidPtr(&pp->getReachableDest()); break;
+        case FIELD_knownTargets: return toVoidPtr(&pp->getKnownTargets(i)); break;
         default: return nullptr;
     }
 }
@@ -55,6 +55,7 @@ class SourceRoutingHeader;
 
 // cplusplus {{
 	#include "inet/routing/rpl/RplDefs.h"
+	#include "inet/routing/rpl/CompressedSourceRoute.h"
    // #include "inet/common/geometry/common/Coord.h"  //CL:because it was creating conflict with geometric.h, after I moved the code to inet folder
 	#include <deque>
 	#include <stdint.h>
@@ -406,6 +407,7 @@ inline void doParsimUnpacking(omnetpp::cCommBuffer *b, Dio& obj) {obj.parsimUnpa
  *     Ipv6Address reachableDest;	// advertised reachable destination		
  *     uint8_t chOffset;			// advertised channel offset (unique per branch)
  *     						    // as part of cross-layer scheduling 
+ *     Ipv6Address knownTargets[];	// all targets of a multi-target DAO, empty for a single target
  * }
  * </pre>
  */
@@ -416,6 +418,8 @@ class INET_API Dao : public ::inet::RplPacket
     bool daoAckRequired = false;
     Ipv6Address reachableDest;
     uint8_t chOffset = 0;
+    Ipv6Address *knownTargets = nullptr;
+    size_t knownTargets_arraysize = 0;
 
   private:
     void copy(const Dao& other);
@@ -443,18 +447,21 @@ class INET_API Dao : public ::inet::RplPacket
     virtual void setReachableDest(const Ipv6Address& reachableDest);
     virtual uint8_t getChOffset() const;
     virtual void setChOffset(uint8_t chOffset);
-
-	std::vector<Ipv6Address> knownTargets; 
-	
-	std::vector<Ipv6Address> getKnownTargets() { return this->knownTargets; }
-	void setKnownTargets(std::vector<Ipv6Address> knownTargets) { handleChange(); this->knownTargets = knownTargets; }
+    virtual void setKnownTargetsArraySize(size_t size);
+    virtual size_t getKnownTargetsArraySize() const;
+    virtual const Ipv6Address& getKnownTargets(size_t k) const;
+    virtual Ipv6Address& getKnownTargetsForUpdate(size_t k) { handleChange();return const_cast<Ipv6Address&>(const_cast<Dao*>(this)->getKnownTargets(k));}
+    virtual void setKnownTargets(size_t k, const Ipv6Address& knownTargets);
+    virtual void insertKnownTargets(const Ipv6Address& knownTargets);
+    virtual void insertKnownTargets(size_t k, const Ipv6Address& knownTargets);
+    virtual void eraseKnownTargets(size_t k);
 };
 
 inline void doParsimPacking(omnetpp::cCommBuffer *b, const Dao& obj) {obj.parsimPack(b);}
 inline void doParsimUnpacking(omnetpp::cCommBuffer *b, Dao& obj) {obj.parsimUnpack(b);}
 
 /**
- * Class generated from <tt>inet/routing/rpl/Rpl.msg:150</tt> by nedtool.
+ * Class generated from <tt>inet/routing/rpl/Rpl.msg:144</tt> by nedtool.
  * <pre>
  * // DODAG Information Solicitation
  * class Dis extends RplPacket
@@ -489,7 +496,7 @@ inline void doParsimPacking(omnetpp::cCommBuffer *b, const Dis& obj) {obj.parsim
 inline void doParsimUnpacking(omnetpp::cCommBuffer *b, Dis& obj) {obj.parsimUnpack(b);}
 
 /**
- * Class generated from <tt>inet/routing/rpl/Rpl.msg:155</tt> by nedtool.
+ * Class generated from <tt>inet/routing/rpl/Rpl.msg:149</tt> by nedtool.
  * <pre>
  * // RPL Information Packet header [RFC 6550 11.2]
  * class RplPacketInfo extends RplPacket
@@ -540,7 +547,7 @@ inline void doParsimPacking(omnetpp::cCommBuffer *b, const RplPacketInfo& obj) {
 inline void doParsimUnpacking(omnetpp::cCommBuffer *b, RplPacketInfo& obj) {obj.parsimUnpack(b);}
 
 /**
- * Class generated from <tt>inet/routing/rpl/Rpl.msg:163</tt> by nedtool.
+ * Class generated from <tt>inet/routing/rpl/Rpl.msg:157</tt> by nedtool.
  * <pre>
  * class RplTargetInfo extends RplPacket
  * {
@@ -580,7 +587,7 @@ inline void doParsimPacking(omnetpp::cCommBuffer *b, const RplTargetInfo& obj) {
 inline void doParsimUnpacking(omnetpp::cCommBuffer *b, RplTargetInfo& obj) {obj.parsimUnpack(b);}
 
 /**
- * Class generated from <tt>inet/routing/rpl/Rpl.msg:168</tt> by nedtool.
+ * Class generated from <tt>inet/routing/rpl/Rpl.msg:162</tt> by nedtool.
  * <pre>
  * class RplTransitInfo extends RplPacket
  * {
@@ -620,7 +627,7 @@ inline void doParsimPacking(omnetpp::cCommBuffer *b, const RplTransitInfo& obj)
 inline void doParsimUnpacking(omnetpp::cCommBuffer *b, RplTransitInfo& obj) {obj.parsimUnpack(b);}
 
 /**
- * Class generated from <tt>inet/routing/rpl/Rpl.msg:175</tt> by nedtool.
+ * Class generated from <tt>inet/routing/rpl/Rpl.msg:169</tt> by nedtool.
  * <pre>
  * class SourceRoutingHeader extends FieldsChunk
  * {
@@ -649,10 +656,11 @@ class INET_API SourceRoutingHeader : public ::inet::FieldsChunk
 
     // field getter/setter methods
 
-    std::deque<Ipv6Address> addresses;
-    
-    std::deque<Ipv6Address> getAddresses() { return this->addresses; }
-    void setAddresses(std::deque<Ipv6Address> hopList) { handleChange(); this->addresses = hopList; }	
+    // hops in RFC 6554 compressed form, the chunk length is taken from it
+    CompressedSourceRoute route;
+
+    const CompressedSourceRoute& getRoute() const { return this->route; }
+    void setRoute(const CompressedSourceRoute& route) { handleChange(); this->route = route; setChunkLength(route.getLength()); }
 };
 
 inline void doParsimPacking(omnetpp::cCommBuffer *b, const SourceRoutingHeader& obj) {obj.parsimPack(b);}
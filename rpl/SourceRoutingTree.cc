@@ -0,0 +1,119 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <sstream>
+
+#include "inet/routing/rpl/SourceRoutingTree.h"
+
+namespace inet {
+
+int SourceRoutingTree::findNode(const Ipv6Address& address) const
+{
+    auto it = nodeIndex.find(address);
+    return it != nodeIndex.end() ? it->second : -1;
+}
+
+int SourceRoutingTree::getOrAddNode(const Ipv6Address& address)
+{
+    auto result = nodeIndex.emplace(address, (int)nodes.size());
+    if (result.second) {
+        nodes.emplace_back();
+        nodes.back().address = address;
+    }
+    return result.first->second;
+}
+
+void SourceRoutingTree::updateDepths(int node)
+{
+    std::vector<int> pending = { node };
+    while (!pending.empty()) {
+        int current = pending.back();
+        pending.pop_back();
+        nodes[current].depth = nodes[nodes[current].parent].depth + 1;
+        pending.insert(pending.end(), nodes[current].children.begin(), nodes[current].children.end());
+    }
+}
+
+SourceRoutingTree::Result SourceRoutingTree::setTransit(const Ipv6Address& target, const Ipv6Address& transit)
+{
+    int targetNode = getOrAddNode(target);
+    int transitNode = getOrAddNode(transit);
+    int oldParent = nodes[targetNode].parent;
+    if (oldParent == transitNode)
+        return UNCHANGED;
+
+    // the new transit must not be the target itself or one of its descendants
+    for (int ancestor = transitNode; ancestor != -1; ancestor = nodes[ancestor].parent)
+        if (ancestor == targetNode)
+            return LOOP;
+
+    if (oldParent == -1)
+        numTargets++;
+    else {
+        auto& siblings = nodes[oldParent].children;
+        auto it = std::find(siblings.begin(), siblings.end(), targetNode);
+        *it = siblings.back();
+        siblings.pop_back();
+    }
+    nodes[targetNode].parent = transitNode;
+    nodes[transitNode].children.push_back(targetNode);
+    updateDepths(targetNode);
+    return UPDATED;
+}
+
+bool SourceRoutingTree::contains(const Ipv6Address& target) const
+{
+    int node = findNode(target);
+    return node != -1 && nodes[node].parent != -1;
+}
+
+bool SourceRoutingTree::getPath(const Ipv6Address& dest, std::deque<Ipv6Address>& path) const
+{
+    int node = findNode(dest);
+    if (node == -1 || nodes[node].parent == -1)
+        return false;
+
+    path.resize(nodes[node].depth);
+    for (auto it = path.rbegin(); it != path.rend(); ++it, node = nodes[node].parent)
+        *it = nodes[node].address;
+    ASSERT(nodes[node].parent == -1);
+    return true;
+}
+
+size_t SourceRoutingTree::getMemoryUsage() const
+{
+    size_t bytes = nodes.capacity() * sizeof(Node) + unorderedMemoryUsage(nodeIndex);
+    for (const auto& node : nodes)
+        bytes += node.children.capacity() * sizeof(int);
+    return bytes;
+}
+
+std::string SourceRoutingTree::str() const
+{
+    std::ostringstream out;
+    for (const auto& node : nodes)
+        if (node.parent != -1)
+            out << node.address << " => " << nodes[node.parent].address << " (" << node.depth << " hops)" << endl;
+    return out.str();
+}
+
+} // namespace inet
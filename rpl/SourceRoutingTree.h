@@ -0,0 +1,97 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SOURCEROUTINGTREE_H
+#define _SOURCEROUTINGTREE_H
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "inet/common/INETDefs.h"
+#include "inet/routing/rpl/Rpl_m.h"
+
+namespace inet {
+
+/**
+ * Target => transit relations learned by the non-storing root from DAOs, kept
+ * as a parent-pointer tree. Every node caches its depth, i.e. the number of
+ * hops of the source route to it, which is refreshed for the moved subtree
+ * only when a target reports a new transit. A route is then written
+ * back-to-front in one pass over the parent pointers, without lookups.
+ *
+ * Transits that would close a loop are rejected, so every path ends at a node
+ * with no known transit (normally the root itself).
+ */
+class INET_API SourceRoutingTree
+{
+  private:
+    struct Node
+    {
+        Ipv6Address address;
+        int parent = -1;    // node of the transit, -1 if no transit is known
+        int depth = 0;      // number of nodes with a known transit from here up
+        std::vector<int> children;
+    };
+
+    std::vector<Node> nodes;
+    std::unordered_map<Ipv6Address, int, Ipv6AddressHash> nodeIndex;
+    int numTargets = 0;
+
+    int findNode(const Ipv6Address& address) const;
+    int getOrAddNode(const Ipv6Address& address);
+    void updateDepths(int node);
+
+  public:
+    enum Result {
+        UNCHANGED,
+        UPDATED,
+        LOOP,   // rejected, the transit lies below the target
+    };
+
+    /** Record @param transit as the parent of @param target */
+    Result setTransit(const Ipv6Address& target, const Ipv6Address& transit);
+
+    /** @return true if a transit is known for @param target */
+    bool contains(const Ipv6Address& target) const;
+
+    /**
+     * Fill @param path with the source route to @param dest, from the topmost
+     * node with a known transit down to @param dest (the root's first hop is
+     * resolved from the routing table and is not included)
+     * @return false if @param dest is unknown
+     */
+    bool getPath(const Ipv6Address& dest, std::deque<Ipv6Address>& path) const;
+
+    /** @return number of targets with a known transit */
+    int size() const { return numTargets; }
+    void clear() { nodes.clear(); nodeIndex.clear(); numTargets = 0; }
+
+    /** @return approximate heap use in bytes */
+    size_t getMemoryUsage() const;
+
+    std::string str() const;
+};
+
+} // namespace inet
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "inet/routing/rpl/TraceSink.h"
+
+namespace inet {
+
+std::ostream& TraceChannel::beginLine()
+{
+    // reset the formatting state, as a freshly opened std::ofstream would have it
+    line.str(std::string());
+    line.clear();
+    line.flags(std::ios_base::dec | std::ios_base::skipws);
+    line.precision(6);
+    line.width(0);
+    line.fill(' ');
+    return line;
+}
+
+void TraceChannel::commitLine()
+{
+    buffer += line.str();
+    if (buffer.size() >= TraceSink::BLOCK_SIZE)
+        sink->submit(this, buffer);
+}
+
+void TraceChannel::append(const char *data, size_t length)
+{
+    buffer.append(data, length);
+    if (buffer.size() >= TraceSink::BLOCK_SIZE)
+        sink->submit(this, buffer);
+}
+
+TraceSink& TraceSink::getInstance()
+{
+    static TraceSink instance;
+    return instance;
+}
+
+TraceSink::~TraceSink()
+{
+    flush(true);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        terminating = true;
+    }
+    queueChanged.notify_all();
+    if (writer.joinable())
+        writer.join();
+    for (auto channel : channels)
+        delete channel;
+}
+
+TraceChannel *TraceSink::getChannel(const char *fileName, bool binary)
+{
+    // only a handful of channels exist, a linear strcmp is cheaper than hashing
+    if (lastChannel && !strcmp(lastChannel->fileName.c_str(), fileName))
+        return lastChannel;
+    for (auto channel : channels) {
+        if (!strcmp(channel->fileName.c_str(), fileName))
+            return lastChannel = channel;
+    }
+
+    if (!listening && getEnvir()) {
+        getEnvir()->addLifecycleListener(this);
+        listening = true;
+    }
+    if (!writer.joinable())
+        writer = std::thread(&TraceSink::writerLoop, this);
+
+    lastChannel = new TraceChannel(this, fileName, binary);
+    channels.push_back(lastChannel);
+    return lastChannel;
+}
+
+void TraceSink::addProducer(ITraceProducer *producer)
+{
+    if (std::find(producers.begin(), producers.end(), producer) == producers.end())
+        producers.push_back(producer);
+}
+
+void TraceSink::removeProducer(ITraceProducer *producer)
+{
+    producers.erase(std::remove(producers.begin(), producers.end(), producer), producers.end());
+}
+
+void TraceSink::submit(TraceChannel *channel, std::string& data)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        queue.push_back(Block());
+        queue.back().channel = channel;
+        queue.back().data.swap(data);
+    }
+    data.reserve(BLOCK_SIZE + BLOCK_SIZE / 8);
+    queueChanged.notify_all();
+}
+
+void TraceSink::flush(bool close)
+{
+    for (auto producer : producers)
+        producer->flushTrace(close);
+    for (auto channel : channels) {
+        if (!channel->buffer.empty())
+            submit(channel, channel->buffer);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!writer.joinable())
+        return;
+    closeFiles = closeFiles || close;
+    queueChanged.notify_all();
+    queueChanged.wait(lock, [this] { return queue.empty() && !writing && !closeFiles; });
+}
+
+void TraceSink::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        queueChanged.wait(lock, [this] { return terminating || closeFiles || !queue.empty(); });
+
+        while (!queue.empty()) {
+            Block block;
+            std::swap(block, queue.front());
+            queue.pop_front();
+            writing = true;
+            lock.unlock();
+
+            auto& file = files[block.channel];
+            if (!file) {
+                auto mode = block.channel->binary ? std::ios_base::app | std::ios_base::binary : std::ios_base::app;
+                file = new std::ofstream(block.channel->fileName, mode);
+                file->seekp(0, std::ios_base::end);
+                if (!block.channel->header.empty() && file->tellp() == std::streampos(0))
+                    file->write(block.channel->header.data(), block.channel->header.size());
+            }
+            file->write(block.data.data(), block.data.size());
+
+            lock.lock();
+            writing = false;
+        }
+
+        if (closeFiles) {
+            for (auto& entry : files) {
+                entry.second->close();
+                delete entry.second;
+            }
+            files.clear();
+            closeFiles = false;
+        }
+        else {
+            for (auto& entry : files)
+                entry.second->flush();
+        }
+        queueChanged.notify_all();
+
+        if (terminating)
+            break;
+    }
+}
+
+void TraceSink::lifecycleEvent(SimulationLifecycleEventType eventType, cObject *details)
+{
+    switch (eventType) {
+        case LF_ON_SIMULATION_ERROR:
+            flush();
+            break;
+        case LF_ON_RUN_END:
+        case LF_ON_SHUTDOWN:
+            flush(true);
+            break;
+        default:
+            break;
+    }
+}
+
+} // namespace inet
@@ -0,0 +1,191 @@
+/*
+ * Simulation model for RPL (Routing Protocol for Low-Power and Lossy Networks)
+ *
+ * Copyright (C) 2021  Institute of Communication Networks (ComNets),
+ *                     Hamburg University of Technology (TUHH)
+ *           (C) 2021  Yevhenii Shudrenko
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TRACESINK_H
+#define _TRACESINK_H
+
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "inet/common/INETDefs.h"
+
+namespace inet {
+
+class TraceSink;
+
+/**
+ * Producer that collects records of its own (e.g. binary column blocks) and
+ * hands them over to its channel only when asked by the TraceSink.
+ */
+class INET_API ITraceProducer
+{
+  public:
+    virtual ~ITraceProducer() {}
+
+    /**
+     * Appends everything collected so far to the producer's channel.
+     *
+     * @param endOfRun true if the files are about to be closed at the end of a run
+     */
+    virtual void flushTrace(bool endOfRun) = 0;
+};
+
+/**
+ * One St_*.txt output stream. Records are formatted on the simulation thread
+ * into an in-memory buffer, which is handed over to the writer thread of the
+ * TraceSink in large blocks.
+ */
+class INET_API TraceChannel
+{
+    friend class TraceSink;
+    friend class TraceLine;
+
+  private:
+    std::string fileName;
+    std::ostringstream line;    // formatting stream, reused for every record
+    std::string buffer;         // records not yet handed over to the writer
+    std::string header;         // written by the writer whenever the file is empty
+    bool binary;
+    TraceSink *sink;
+
+    TraceChannel(TraceSink *sink, const char *fileName, bool binary) : fileName(fileName), binary(binary), sink(sink) {}
+
+    std::ostream& beginLine();
+    void commitLine();
+
+  public:
+    const std::string& getFileName() const { return fileName; }
+    bool isBinary() const { return binary; }
+
+    /**
+     * Sets the file header (e.g. a schema) that has to precede the records of
+     * an empty file. Must be called before the first record is appended.
+     */
+    void setHeader(const std::string& header) { this->header = header; }
+
+    /**
+     * Appends raw, already serialized records to the channel.
+     */
+    void append(const char *data, size_t length);
+};
+
+/**
+ * Single record of a trace channel. Behaves like the std::ofstream that used
+ * to be opened for every event, and appends the formatted text to the channel
+ * when it goes out of scope.
+ */
+class INET_API TraceLine
+{
+  private:
+    TraceChannel *channel;
+
+  public:
+    explicit TraceLine(TraceChannel *channel) : channel(channel) { channel->beginLine(); }
+    TraceLine(TraceLine&& other) : channel(other.channel) { other.channel = nullptr; }
+    TraceLine(const TraceLine&) = delete;
+    TraceLine& operator=(const TraceLine&) = delete;
+    ~TraceLine() { if (channel) channel->commitLine(); }
+
+    template<typename T>
+    TraceLine& operator<<(const T& value) { channel->line << value; return *this; }
+    TraceLine& operator<<(std::ostream& (*manip)(std::ostream&)) { manip(channel->line); return *this; }
+};
+
+/**
+ * Process-wide sink for the St_*.txt trace files written by RPL, the MAC, IPv6
+ * and the UDP applications. Every file is a named channel; the files are kept
+ * open by a background writer thread and are flushed and closed at the end of
+ * each run, so the text layout stays exactly the same as with per-event appends.
+ */
+class INET_API TraceSink : public cISimulationLifecycleListener
+{
+    friend class TraceChannel;
+
+  private:
+    struct Block {
+        TraceChannel *channel;
+        std::string data;
+    };
+
+    static const size_t BLOCK_SIZE = 1 << 20;
+
+    std::vector<TraceChannel *> channels;
+    std::vector<ITraceProducer *> producers;
+    TraceChannel *lastChannel = nullptr;
+
+    // writer thread state, guarded by mutex
+    std::mutex mutex;
+    std::condition_variable queueChanged;
+    std::deque<Block> queue;
+    bool writing = false;
+    bool closeFiles = false;
+    bool terminating = false;
+    std::thread writer;
+    std::map<TraceChannel *, std::ofstream *> files;
+
+    bool listening = false;
+
+    TraceSink() {}
+    ~TraceSink();
+
+    void submit(TraceChannel *channel, std::string& data);
+    void writerLoop();
+
+  public:
+    static TraceSink& getInstance();
+
+    /**
+     * Returns the channel writing into the given file, creating it on first use.
+     * Channels live until the end of the process, so the pointer may be cached.
+     * Binary channels are opened in binary mode and never mixed with text lines.
+     */
+    TraceChannel *getChannel(const char *fileName, bool binary = false);
+
+    void addProducer(ITraceProducer *producer);
+    void removeProducer(ITraceProducer *producer);
+
+    /**
+     * Starts a new record in the given trace file, e.g.
+     * TraceSink::line("St_DIOsent.txt") << simTime() << " " << name << endl;
+     */
+    static TraceLine line(const char *fileName) { return TraceLine(getInstance().getChannel(fileName)); }
+
+    /**
+     * Asks the producers for their pending records, hands over all buffered
+     * records and blocks until the writer has written them. If close is set,
+     * the files are closed as well (end of a run).
+     */
+    void flush(bool close = false);
+
+    virtual void lifecycleEvent(SimulationLifecycleEventType eventType, cObject *details) override;
+    virtual void listenerRemoved() override { listening = false; }
+};
+
+} // namespace inet
+
+#endif
@@ -7,6 +7,7 @@
 #include <sstream>
 #include <fstream>
 #include "Sink.h"
+#include "inet/routing/rpl/PacketTrace.h"
 
 Define_Module(Sink);
 
@@ -61,9 +62,6 @@ void Sink::initialize()
       setdestAddr(c);  */
 
     //added by CL 2022-01-18
-         std::ofstream file;
-         file.open("St_packet-tracer.txt", std::ios_base::app);
-
          int numMeters = getParentModule()->par("numMeters");
          EV_INFO << "nummeters: " <<numMeters << endl;
               //double simtime = getParentModule()->getParentModule()->par("sim-time-limit");
@@ -72,7 +70,10 @@ void Sink::initialize()
               //EV_INFO << "seed-set: " <<seed << endl;
 
          std::string routing = getParentModule()->par("Routing");
-         file << "NumMeters: "<< numMeters << " - Tech: " << routing << " - seed: " << rand() << endl;
+         std::ostringstream header;
+         header << "NumMeters: "<< numMeters << " - Tech: " << routing << " - seed: " << rand();
+         // through the packet trace, so the line lands in order with the buffered rows
+         inet::PacketTrace::getInstance().recordHeader(header.str());
 }
 
 void Sink::handleMessage(cMessage *msg)
@@ -0,0 +1,118 @@
+/*
+ * Writes a CatBoost model exported as C++ (model.save_model(..., format="cpp"),
+ * the rpl/Catboost.h the simulation compiles in) to a model file that the
+ * objective functions load at run time through their modelFile parameter, so a
+ * retrained model needs no rebuild of the simulation. The layout is described
+ * in rpl/ObliviousForestFormat.h.
+ *
+ * Standalone, no OMNeT++ needed; MODEL selects the exported model, rpl/Catboost.h
+ * by default:
+ *
+ *   g++ -O2 -std=c++14 -Irpl -o ForestExport tools/ForestExport.cc
+ *   g++ -O2 -std=c++14 -Irpl -DMODEL='"/path/to/retrained.cpp"' -o ForestExport tools/ForestExport.cc
+ *   ./ForestExport rank-model.forest
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifndef MODEL
+#define MODEL "Catboost.h"
+#endif
+#include MODEL
+
+#include "ObliviousForestFormat.h"
+
+using namespace inet;
+
+namespace {
+
+// exports of different CatBoost versions store one leaf value per leaf or one per
+// leaf and model dimension, and a single bias or one per dimension
+template <size_t N>
+double leafValue(const double (&values)[N], size_t leaf) { return values[leaf]; }
+
+template <size_t N, size_t D>
+double leafValue(const double (&values)[N][D], size_t leaf) { return values[leaf][0]; }
+
+template <typename Model>
+auto modelBias(const Model& model, int) -> decltype((double)model.Biases[0]) { return model.Biases[0]; }
+
+template <typename Model>
+double modelBias(const Model& model, long) { return model.Bias; }
+
+template <typename T>
+void writeSection(std::ofstream& out, const std::vector<T>& values)
+{
+    static const char padding[8] = {};
+    size_t length = values.size() * sizeof(T);
+    out.write(reinterpret_cast<const char *>(values.data()), length);
+    out.write(padding, obliviousForestAlign(length) - length);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        std::cerr << "usage: " << argv[0] << " <model file>" << std::endl;
+        return 1;
+    }
+
+    const auto& model = CatboostModelStatic;
+    std::vector<int32_t> borderCounts(model.BorderCounts, model.BorderCounts + model.FloatFeatureCount);
+    std::vector<float> borders(model.Borders, model.Borders + model.BinaryFeatureCount);
+    std::vector<int32_t> treeDepths(model.TreeDepth, model.TreeDepth + model.TreeCount);
+    std::vector<int32_t> treeSplits;
+    std::vector<double> leafValues;
+    const unsigned int *splits = model.TreeSplits;
+    for (int32_t depth : treeDepths) {
+        treeSplits.insert(treeSplits.end(), splits, splits + depth);
+        splits += depth;
+        for (size_t i = 0; i < (size_t)1 << depth; i++)
+            leafValues.push_back(leafValue(model.LeafValues, leafValues.size()));
+    }
+
+    ObliviousForestFileHeader header = {};
+    memcpy(header.magic, OBLIVIOUS_FOREST_MAGIC, sizeof(header.magic));
+    header.version = OBLIVIOUS_FOREST_VERSION;
+    header.featureCount = borderCounts.size();
+    header.borderCount = borders.size();
+    header.treeCount = treeDepths.size();
+    header.splitCount = treeSplits.size();
+    header.leafCount = leafValues.size();
+    header.scale = model.Scale;
+    header.bias = modelBias(model, 0);
+
+    std::ofstream out(argv[1], std::ios::binary);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writeSection(out, leafValues);
+    writeSection(out, borders);
+    writeSection(out, borderCounts);
+    writeSection(out, treeDepths);
+    writeSection(out, treeSplits);
+    out.close();
+    if (!out) {
+        perror(argv[1]);
+        return 1;
+    }
+    std::cerr << argv[1] << ": " << header.featureCount << " features, " << header.treeCount << " trees, "
+              << obliviousForestFileSize(header) << " bytes" << std::endl;
+    return 0;
+}
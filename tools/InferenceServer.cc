@@ -0,0 +1,184 @@
+/*
+ * Local stand-in for the ML inference server queried by the objective
+ * functions through InferenceClient (rpl/InferenceClient.h), for running and
+ * testing the remote prediction path without the trained model.
+ *
+ * It speaks the same line protocol: every request line holds the features
+ * "bw den etx_onlink fps drops", every answer line the probability of a
+ * successful transmission. The stand-in estimates it as 1 / etx_onlink.
+ * Requests are answered in order, pipelined requests in one batch, and any
+ * number of clients is served at once.
+ *
+ * Standalone, no OMNeT++ needed:
+ *
+ *   g++ -O2 -std=c++14 -o InferenceServer tools/InferenceServer.cc
+ *   ./InferenceServer [--delay ms] 127.0.0.1:5005
+ *   ./InferenceServer [--delay ms] unix:/tmp/rpl-inference.sock
+ *
+ * --delay holds every answer back, e.g. to exceed the client's inferenceTimeout.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+const int FEATURE_COUNT = 5;
+
+struct Client
+{
+    std::string received;
+    std::string pending;    // answers not yet written
+};
+
+/** @return the answer line for one request line, an error for malformed ones so the client drops them */
+std::string answer(const std::string& line)
+{
+    std::istringstream in(line);
+    double features[FEATURE_COUNT];
+    for (double& feature : features)
+        if (!(in >> feature))
+            return "error\n";
+    double etx = features[2];
+    char probability[32];
+    snprintf(probability, sizeof(probability), "%.6f\n", etx <= 1 ? 1 : 1 / etx);
+    return probability;
+}
+
+int listenOn(const std::string& address)
+{
+    int fd;
+    if (address.compare(0, 5, "unix:") == 0) {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        std::string path = address.substr(5);
+        if (path.size() >= sizeof(addr.sun_path))
+            return -1;
+        strcpy(addr.sun_path, path.c_str());
+        unlink(path.c_str());
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || bind(fd, (const sockaddr *)&addr, sizeof(addr)) < 0)
+            return -1;
+    }
+    else {
+        size_t colon = address.rfind(':');
+        std::string host = colon == std::string::npos ? "127.0.0.1" : address.substr(0, colon);
+        std::string port = colon == std::string::npos ? address : address.substr(colon + 1);
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE;
+        addrinfo *results = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &results) != 0)
+            return -1;
+        fd = socket(results->ai_family, SOCK_STREAM, 0);
+        int on = 1;
+        if (fd >= 0)
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        bool bound = fd >= 0 && bind(fd, results->ai_addr, results->ai_addrlen) == 0;
+        freeaddrinfo(results);
+        if (!bound)
+            return -1;
+    }
+    return listen(fd, 64) == 0 ? fd : -1;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int delayMs = 0;
+    std::string address;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--delay") == 0 && i + 1 < argc)
+            delayMs = atoi(argv[++i]);
+        else
+            address = argv[i];
+    }
+    if (address.empty()) {
+        std::cerr << "usage: " << argv[0] << " [--delay ms] <host:port | port | unix:path>" << std::endl;
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    int listener = listenOn(address);
+    if (listener < 0) {
+        perror(address.c_str());
+        return 1;
+    }
+    std::cerr << "Serving predictions on " << address << std::endl;
+
+    std::map<int, Client> clients;
+    while (true) {
+        std::vector<pollfd> fds = { { listener, POLLIN, 0 } };
+        for (const auto& client : clients)
+            fds.push_back({ client.first, (short)(POLLIN | (client.second.pending.empty() ? 0 : POLLOUT)), 0 });
+        if (poll(fds.data(), fds.size(), -1) < 0)
+            continue;
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listener, nullptr, nullptr);
+            if (fd >= 0)
+                clients[fd];
+        }
+        for (size_t i = 1; i < fds.size(); i++) {
+            int fd = fds[i].fd;
+            Client& client = clients[fd];
+            bool closed = false;
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                char buffer[4096];
+                ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+                if (n <= 0)
+                    closed = true;
+                else {
+                    client.received.append(buffer, n);
+                    size_t start = 0, end;
+                    while ((end = client.received.find('\n', start)) != std::string::npos) {
+                        client.pending += answer(client.received.substr(start, end - start));
+                        start = end + 1;
+                    }
+                    client.received.erase(0, start);
+                    if (delayMs > 0 && start > 0)
+                        usleep(delayMs * 1000);
+                }
+            }
+            if (!closed && (fds[i].revents & POLLOUT)) {
+                ssize_t n = send(fd, client.pending.data(), client.pending.size(), 0);
+                if (n < 0)
+                    closed = true;
+                else
+                    client.pending.erase(0, n);
+            }
+            if (closed) {
+                close(fd);
+                clients.erase(fd);
+            }
+        }
+    }
+}
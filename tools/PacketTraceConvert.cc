@@ -0,0 +1,227 @@
+/*
+ * Converts the binary packet trace (St_packet-tracer.bin, written when the
+ * simulation runs with packet-trace-format = "binary") back into the text
+ * layout of St_packet-tracer.txt, or into CSV with a header row.
+ *
+ * Standalone, no OMNeT++ needed:
+ *
+ *   g++ -O2 -std=c++14 -Irpl -o PacketTraceConvert tools/PacketTraceConvert.cc
+ *   ./PacketTraceConvert St_packet-tracer.bin > St_packet-tracer.txt
+ *   ./PacketTraceConvert --csv St_packet-tracer.bin > St_packet-tracer.csv
+ *
+ * The training set export (St_features.bin, feature-export = true) has the
+ * same layout and converts the same way.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "PacketTraceFormat.h"
+
+using namespace inet;
+
+namespace {
+
+struct Column
+{
+    std::string name;
+    uint8_t type;
+    uint8_t width;
+};
+
+/**
+ * Prints a raw simtime value the way SimTime's operator<< does: integral
+ * values without a decimal point, otherwise without trailing zeros.
+ */
+void printSimtime(std::ostream& os, int64_t raw, int scaleExp)
+{
+    if (raw < 0) {
+        os << "-";
+        raw = -raw;
+    }
+    int64_t scale = 1;
+    for (int i = 0; i < -scaleExp; i++)
+        scale *= 10;
+    os << raw / scale;
+    int64_t fraction = raw % scale;
+    if (fraction == 0)
+        return;
+    std::string digits = std::to_string(fraction);
+    digits.insert(0, -scaleExp - digits.size(), '0');
+    digits.erase(digits.find_last_not_of('0') + 1);
+    os << "." << digits;
+}
+
+void printCsvString(std::ostream& os, const char *value)
+{
+    if (!strpbrk(value, ",\"\n")) {
+        os << value;
+        return;
+    }
+    os << '"';
+    for (const char *p = value; *p; p++) {
+        if (*p == '"')
+            os << '"';
+        os << *p;
+    }
+    os << '"';
+}
+
+bool readExactly(std::istream& in, void *data, size_t length)
+{
+    in.read((char *)data, length);
+    return (size_t)in.gcount() == length;
+}
+
+int usage()
+{
+    std::cerr << "usage: PacketTraceConvert [--text|--csv] St_packet-tracer.bin" << std::endl;
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bool csv = false;
+    const char *fileName = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--csv"))
+            csv = true;
+        else if (!strcmp(argv[i], "--text"))
+            csv = false;
+        else if (!fileName)
+            fileName = argv[i];
+        else
+            return usage();
+    }
+    if (!fileName)
+        return usage();
+
+    std::ifstream in(fileName, std::ios_base::binary);
+    if (!in) {
+        std::cerr << "cannot open " << fileName << std::endl;
+        return 1;
+    }
+
+    PacketTraceFileHeader fileHeader;
+    if (!readExactly(in, &fileHeader, sizeof(fileHeader)) || memcmp(fileHeader.magic, PACKET_TRACE_MAGIC, sizeof(fileHeader.magic))) {
+        std::cerr << fileName << ": not a binary packet trace" << std::endl;
+        return 1;
+    }
+    if (fileHeader.version != PACKET_TRACE_VERSION) {
+        std::cerr << fileName << ": unsupported version " << fileHeader.version << std::endl;
+        return 1;
+    }
+
+    std::vector<Column> columns;
+    for (uint32_t i = 0; i < fileHeader.numColumns; i++) {
+        PacketTraceColumnHeader columnHeader;
+        if (!readExactly(in, &columnHeader, sizeof(columnHeader))) {
+            std::cerr << fileName << ": truncated schema" << std::endl;
+            return 1;
+        }
+        Column column;
+        column.name.assign(columnHeader.name, strnlen(columnHeader.name, sizeof(columnHeader.name)));
+        column.type = columnHeader.type;
+        column.width = columnHeader.width;
+        if (column.width != packetTraceColumnWidth(column.type)) {
+            std::cerr << fileName << ": bad column " << column.name << std::endl;
+            return 1;
+        }
+        columns.push_back(column);
+    }
+
+    std::ostream& os = std::cout;
+    const char *separator = csv ? "," : " ";
+    if (csv) {
+        for (size_t c = 0; c < columns.size(); c++)
+            os << (c ? separator : "") << columns[c].name;
+        os << "\n";
+    }
+
+    std::vector<std::vector<char>> data(columns.size());
+    std::vector<char> heap;
+    PacketTraceBlockHeader blockHeader;
+    while (readExactly(in, &blockHeader, sizeof(blockHeader))) {
+        if (blockHeader.magic != PACKET_TRACE_BLOCK_MAGIC) {
+            std::cerr << fileName << ": corrupt block" << std::endl;
+            return 1;
+        }
+        for (size_t c = 0; c < columns.size(); c++) {
+            data[c].resize(packetTraceAlign((size_t)blockHeader.numRows * columns[c].width));
+            if (!readExactly(in, data[c].data(), data[c].size())) {
+                std::cerr << fileName << ": truncated block" << std::endl;
+                return 1;
+            }
+        }
+        heap.resize(packetTraceAlign(blockHeader.heapSize) + 1);
+        if (!readExactly(in, heap.data(), heap.size() - 1)) {
+            std::cerr << fileName << ": truncated block" << std::endl;
+            return 1;
+        }
+        heap.back() = '\0';
+
+        for (uint32_t row = 0; row < blockHeader.numRows; row++) {
+            for (size_t c = 0; c < columns.size(); c++) {
+                const char *value = data[c].data() + (size_t)row * columns[c].width;
+                if (c > 0)
+                    os << separator;
+                switch (columns[c].type) {
+                    case PT_SIMTIME: {
+                        int64_t raw;
+                        memcpy(&raw, value, sizeof(raw));
+                        printSimtime(os, raw, fileHeader.simtimeScaleExp);
+                        break;
+                    }
+                    case PT_STRING: {
+                        uint32_t offset;
+                        memcpy(&offset, value, sizeof(offset));
+                        const char *string = offset < blockHeader.heapSize ? heap.data() + offset : "";
+                        if (csv)
+                            printCsvString(os, string);
+                        else
+                            os << string;
+                        break;
+                    }
+                    case PT_INT32: {
+                        int32_t number;
+                        memcpy(&number, value, sizeof(number));
+                        os << number;
+                        break;
+                    }
+                    case PT_INT64: {
+                        int64_t number;
+                        memcpy(&number, value, sizeof(number));
+                        os << number;
+                        break;
+                    }
+                    case PT_DOUBLE: {
+                        double number;
+                        memcpy(&number, value, sizeof(number));
+                        os << number;
+                        break;
+                    }
+                }
+            }
+            os << "\n";
+        }
+    }
+    return 0;
+}
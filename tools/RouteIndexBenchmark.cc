@@ -0,0 +1,228 @@
+/*
+ * Measures the cost of DAO processing at the sink (root) with the former
+ * linear routing-table scans (checkDestKnown() + checkDuplicateRoute()) and
+ * with the destination-keyed route index of Rpl (rplRoutes).
+ *
+ * The routing table is modelled as Ipv6RoutingTable keeps it, a vector of
+ * routes sorted by destination. Each run learns one /128 route per meter from
+ * its first DAO, then replays refresh rounds in which every meter re-advertises
+ * itself and 10% of them arrive via a different next hop. Insertion into the
+ * sorted table is the same for both variants, only the lookups differ.
+ *
+ * Standalone, no OMNeT++ needed:
+ *
+ *   g++ -O2 -std=c++14 -o RouteIndexBenchmark tools/RouteIndexBenchmark.cc
+ *   ./RouteIndexBenchmark [rounds] [numMeters...]
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct Address
+{
+    uint32_t words[4];
+
+    bool operator==(const Address& other) const { return std::equal(words, words + 4, other.words); }
+    bool operator!=(const Address& other) const { return !(*this == other); }
+    bool operator<(const Address& other) const { return std::lexicographical_compare(words, words + 4, other.words, other.words + 4); }
+};
+
+/** Same mixing as Ipv6AddressHash in rpl/RplDefs.h */
+struct AddressHash
+{
+    size_t operator()(const Address& address) const {
+        size_t hash = address.words[0];
+        for (int i = 1; i < 4; i++)
+            hash = hash * 0x9E3779B1u + address.words[i];
+        return hash;
+    }
+};
+
+struct Route
+{
+    Address dest;
+    Address nextHop;
+};
+
+struct Dao
+{
+    Address sender;
+    Address dest;
+};
+
+Address meterAddress(int id)
+{
+    // global unicast addresses as assigned by the network configurator
+    return Address{ { 0xfd000000u, 0, 0, (uint32_t)id + 1 } };
+}
+
+class RoutingTable
+{
+  private:
+    std::vector<std::unique_ptr<Route>> routes;
+
+  public:
+    int getNumRoutes() const { return (int)routes.size(); }
+    Route *getRoute(int i) const { return routes[i].get(); }
+
+    void addRoute(Route *route) {
+        auto it = std::lower_bound(routes.begin(), routes.end(), route->dest,
+                [] (const std::unique_ptr<Route>& r, const Address& dest) { return r->dest < dest; });
+        routes.emplace(it, route);
+    }
+
+    void deleteRoute(Route *route) {
+        auto it = std::find_if(routes.begin(), routes.end(),
+                [route] (const std::unique_ptr<Route>& r) { return r.get() == route; });
+        routes.erase(it);
+    }
+};
+
+/** DAO handling at the root before the index: scans in checkDestKnown() and checkDuplicateRoute() */
+class ScanningRoot
+{
+  public:
+    RoutingTable routingTable;
+
+    void processDao(const Dao& dao) {
+        Route *outdatedRoute = nullptr;
+        for (int i = 0; i < routingTable.getNumRoutes(); i++) {
+            auto ri = routingTable.getRoute(i);
+            if (ri->dest == dao.dest) {
+                if (ri->nextHop == dao.sender)
+                    return;
+                outdatedRoute = ri;
+                break;
+            }
+        }
+        if (outdatedRoute)
+            routingTable.deleteRoute(outdatedRoute);
+
+        for (int i = 0; i < routingTable.getNumRoutes(); i++) {
+            auto rt = routingTable.getRoute(i);
+            if (rt->dest == dao.dest) {
+                rt->nextHop = dao.sender;
+                return;
+            }
+        }
+        routingTable.addRoute(new Route{ dao.dest, dao.sender });
+    }
+};
+
+/** DAO handling at the root with the destination-keyed index */
+class IndexedRoot
+{
+  public:
+    RoutingTable routingTable;
+    std::unordered_map<Address, Route *, AddressHash> rplRoutes;
+
+    void processDao(const Dao& dao) {
+        auto it = rplRoutes.find(dao.dest);
+        if (it != rplRoutes.end()) {
+            if (it->second->nextHop == dao.sender)
+                return;
+            routingTable.deleteRoute(it->second);
+            rplRoutes.erase(it);    // done by routeDeletedSignal in Rpl
+        }
+
+        auto route = new Route{ dao.dest, dao.sender };
+        routingTable.addRoute(route);
+        rplRoutes[dao.dest] = route;
+    }
+};
+
+std::vector<Dao> makeDaos(int numMeters, int rounds)
+{
+    std::mt19937 rng(numMeters);
+    int numChildren = std::max(1, numMeters / 50);  // 1-hop neighbors of the sink
+    std::uniform_int_distribution<int> child(0, numChildren - 1);
+    std::uniform_real_distribution<double> uniform(0, 1);
+
+    std::vector<Address> nextHops(numMeters);
+    for (int i = 0; i < numMeters; i++)
+        nextHops[i] = i < numChildren ? meterAddress(i) : meterAddress(child(rng));
+
+    std::vector<int> order(numMeters);
+    for (int i = 0; i < numMeters; i++)
+        order[i] = i;
+
+    std::vector<Dao> daos;
+    daos.reserve((size_t)numMeters * (rounds + 1));
+    for (int round = 0; round <= rounds; round++) {
+        std::shuffle(order.begin(), order.end(), rng);
+        for (int i : order) {
+            if (round > 0 && i >= numChildren && uniform(rng) < 0.1)
+                nextHops[i] = meterAddress(child(rng));
+            daos.push_back(Dao{ nextHops[i], meterAddress(i) });
+        }
+    }
+    return daos;
+}
+
+template<typename Root>
+double run(const std::vector<Dao>& daos, int& numRoutes)
+{
+    Root root;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& dao : daos)
+        root.processDao(dao);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    numRoutes = root.routingTable.getNumRoutes();
+    return elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int rounds = argc > 1 ? atoi(argv[1]) : 10;
+    std::vector<int> sizes;
+    for (int i = 2; i < argc; i++)
+        sizes.push_back(atoi(argv[i]));
+    if (sizes.empty())
+        sizes = { 1000, 5000, 10000 };
+
+    std::cout << "DAO processing at the sink, " << rounds << " refresh rounds" << std::endl;
+    std::cout << std::setw(8) << "meters" << std::setw(10) << "DAOs"
+              << std::setw(16) << "scan us/DAO" << std::setw(16) << "index us/DAO"
+              << std::setw(10) << "speedup" << std::endl;
+    for (int numMeters : sizes) {
+        auto daos = makeDaos(numMeters, rounds);
+        int scanRoutes, indexRoutes;
+        double scanTime = run<ScanningRoot>(daos, scanRoutes);
+        double indexTime = run<IndexedRoot>(daos, indexRoutes);
+        if (scanRoutes != indexRoutes) {
+            std::cerr << "route count mismatch: " << scanRoutes << " vs " << indexRoutes << std::endl;
+            return 1;
+        }
+        std::cout << std::setw(8) << numMeters << std::setw(10) << daos.size()
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(16) << scanTime * 1e6 / daos.size()
+                  << std::setw(16) << indexTime * 1e6 / daos.size()
+                  << std::setprecision(1) << std::setw(9) << scanTime / indexTime << "x" << std::endl;
+    }
+    return 0;
+}